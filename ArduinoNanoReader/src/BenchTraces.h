@@ -0,0 +1,81 @@
+#ifndef BENCH_TRACES_H
+#define BENCH_TRACES_H
+
+#include <Arduino.h>
+
+// traces for benchmark mode. frames have the same layout as on RS485 line between
+// Arduino Uno and Arduino Nano (Channel frame: 0x06 0x85, size, Message, checksum)
+
+// wiegand frame as it comes from reader head
+struct BenchSwipe
+{
+    uint8_t     bits;                           // frame length (34 - normal card, other - noise)
+    uint32_t    data;                           // data bits (without parity bits)
+    uint8_t     parity;                         // bit 1 - leading even parity, bit 0 - trailing odd parity
+};
+
+// swipes of a few site cards with short noise bursts between them
+const BenchSwipe bt_swipes[] PROGMEM =
+{
+    { 34, 0x0049A2F1, 3 },
+    { 34, 0x00B7C3D2, 1 },
+    {  5, 0x0000001B, 0 },
+    { 34, 0x3A01F5E6, 2 },
+    { 34, 0x0012AB34, 1 },
+    { 34, 0x7F00E1C8, 2 },
+    {  2, 0x00000001, 0 },
+    { 34, 0x00D4E5F6, 0 },
+    { 34, 0x1C2B3A49, 2 },
+    { 34, 0x006A7B8C, 0 },
+};
+
+// master responses for readers 801-804 (and one ethernet status broadcast), frames back to back
+const uint8_t bt_bus_clean[] PROGMEM =
+{
+    0x06, 0x85, 0x0A, 0x23, 0x03, 0xE6, 0xF5, 0x01, 0x3A, 0x04, 0x00, 0x00, 0x00, 0x06,
+    0x06, 0x85, 0x0A, 0x21, 0x03, 0xD2, 0xC3, 0xB7, 0x00, 0x63, 0x00, 0x00, 0x00, 0xED,
+    0x06, 0x85, 0x0A, 0x21, 0x03, 0xF6, 0xE5, 0xD4, 0x00, 0x01, 0x00, 0x00, 0x00, 0xEE,
+    0x06, 0x85, 0x0A, 0xE7, 0x03, 0x00, 0x00, 0x00, 0x00, 0x64, 0x00, 0x01, 0x00, 0x8B,
+    0x06, 0x85, 0x0A, 0x22, 0x03, 0xF1, 0xA2, 0x49, 0x00, 0x01, 0x00, 0x00, 0x00, 0x30,
+    0x06, 0x85, 0x0A, 0x24, 0x03, 0x49, 0x3A, 0x2B, 0x1C, 0x01, 0x00, 0x00, 0x00, 0x68,
+    0x06, 0x85, 0x0A, 0x22, 0x03, 0xD2, 0xC3, 0xB7, 0x00, 0x63, 0x00, 0x00, 0x00, 0xEE,
+    0x06, 0x85, 0x0A, 0x24, 0x03, 0xF1, 0xA2, 0x49, 0x00, 0x01, 0x00, 0x00, 0x00, 0x36,
+    0x06, 0x85, 0x0A, 0x22, 0x03, 0xF1, 0xA2, 0x49, 0x00, 0x04, 0x00, 0x00, 0x00, 0x35,
+    0x06, 0x85, 0x0A, 0x21, 0x03, 0x34, 0xAB, 0x12, 0x00, 0x01, 0x00, 0x00, 0x00, 0xA4,
+    0x06, 0x85, 0x0A, 0x22, 0x03, 0xC8, 0xE1, 0x00, 0x7F, 0x04, 0x00, 0x00, 0x00, 0x79,
+    0x06, 0x85, 0x0A, 0x22, 0x03, 0xD2, 0xC3, 0xB7, 0x00, 0x02, 0x00, 0x00, 0x00, 0x8F,
+    0x06, 0x85, 0x0A, 0x22, 0x03, 0xD2, 0xC3, 0xB7, 0x00, 0x01, 0x00, 0x00, 0x00, 0x8C,
+    0x06, 0x85, 0x0A, 0x23, 0x03, 0xD2, 0xC3, 0xB7, 0x00, 0x63, 0x00, 0x00, 0x00, 0xEF,
+    0x06, 0x85, 0x0A, 0x21, 0x03, 0xF1, 0xA2, 0x49, 0x00, 0x01, 0x00, 0x00, 0x00, 0x33,
+    0x06, 0x85, 0x0A, 0x24, 0x03, 0x49, 0x3A, 0x2B, 0x1C, 0x03, 0x00, 0x00, 0x00, 0x6A,
+    0x06, 0x85, 0x0A, 0x24, 0x03, 0x8C, 0x7B, 0x6A, 0x00, 0x03, 0x00, 0x00, 0x00, 0xB3,
+};
+
+// the same responses with line noise between frames
+const uint8_t bt_bus_noisy[] PROGMEM =
+{
+    0xFF, 0xFF, 0x06, 0x06, 0x85, 0x0A, 0x23, 0x03, 0xE6, 0xF5, 0x01, 0x3A, 0x04, 0x00,
+    0x00, 0x00, 0x06, 0x00, 0x20, 0x06, 0x85, 0x0A, 0x21, 0x03, 0xD2, 0xC3, 0xB7, 0x00,
+    0x63, 0x00, 0x00, 0x00, 0xED, 0x20, 0x85, 0x7F, 0x06, 0x85, 0x0A, 0x21, 0x03, 0xF6,
+    0xE5, 0xD4, 0x00, 0x01, 0x00, 0x00, 0x00, 0xEE, 0x85, 0x7F, 0x20, 0x00, 0x00, 0x20,
+    0x06, 0x85, 0x0A, 0xE7, 0x03, 0x00, 0x00, 0x00, 0x00, 0x64, 0x00, 0x01, 0x00, 0x8B,
+    0xFF, 0x7F, 0xFF, 0x85, 0x06, 0x85, 0x0A, 0x22, 0x03, 0xF1, 0xA2, 0x49, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x30, 0x00, 0x06, 0x00, 0x20, 0x06, 0x85, 0x0A, 0x24, 0x03, 0x49,
+    0x3A, 0x2B, 0x1C, 0x01, 0x00, 0x00, 0x00, 0x68, 0x7F, 0x7F, 0x06, 0x7F, 0x20, 0x06,
+    0x85, 0x0A, 0x22, 0x03, 0xD2, 0xC3, 0xB7, 0x00, 0x63, 0x00, 0x00, 0x00, 0xEE, 0x20,
+    0x85, 0x00, 0x00, 0x06, 0x85, 0x0A, 0x24, 0x03, 0xF1, 0xA2, 0x49, 0x00, 0x01, 0x00,
+    0x00, 0x00, 0x36, 0x85, 0x06, 0x06, 0x06, 0x85, 0x0A, 0x22, 0x03, 0xF1, 0xA2, 0x49,
+    0x00, 0x04, 0x00, 0x00, 0x00, 0x35, 0x00, 0x06, 0x85, 0x0A, 0x21, 0x03, 0x34, 0xAB,
+    0x12, 0x00, 0x01, 0x00, 0x00, 0x00, 0xA4, 0x06, 0x7F, 0x06, 0x20, 0x06, 0x85, 0x06,
+    0x85, 0x0A, 0x22, 0x03, 0xC8, 0xE1, 0x00, 0x7F, 0x04, 0x00, 0x00, 0x00, 0x79, 0x06,
+    0x85, 0x06, 0x06, 0x85, 0x0A, 0x22, 0x03, 0xD2, 0xC3, 0xB7, 0x00, 0x02, 0x00, 0x00,
+    0x00, 0x8F, 0x00, 0x85, 0x7F, 0x06, 0x85, 0x0A, 0x22, 0x03, 0xD2, 0xC3, 0xB7, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x8C, 0x20, 0x00, 0x06, 0x85, 0x0A, 0x23, 0x03, 0xD2, 0xC3,
+    0xB7, 0x00, 0x63, 0x00, 0x00, 0x00, 0xEF, 0x00, 0xFF, 0x7F, 0xFF, 0x06, 0x85, 0x0A,
+    0x21, 0x03, 0xF1, 0xA2, 0x49, 0x00, 0x01, 0x00, 0x00, 0x00, 0x33, 0xFF, 0x85, 0x85,
+    0x85, 0x00, 0xFF, 0x06, 0x85, 0x0A, 0x24, 0x03, 0x49, 0x3A, 0x2B, 0x1C, 0x03, 0x00,
+    0x00, 0x00, 0x6A, 0x85, 0x20, 0x7F, 0xFF, 0x06, 0x85, 0x0A, 0x24, 0x03, 0x8C, 0x7B,
+    0x6A, 0x00, 0x03, 0x00, 0x00, 0x00, 0xB3,
+};
+
+#endif
@@ -0,0 +1,328 @@
+#include "Benchmark.h"
+#include <BenchTraces.h>
+#include <Profiler.h>
+#include <WiegandReader.h>
+
+#define bench_passes    20                      // passes over every trace
+#define bench_frame     (sizeof(Message) + 4)   // bus frame length (header, size, checksum)
+#define link_frames     300                     // frames per line quality level
+#define link_device     801                     // device id of generated frames
+
+// line quality levels: bit errors, dropped bytes, noise bursts (all per 10000 bytes), max noise burst length
+struct LinkLevel
+{
+    uint16_t    bit_errors;
+    uint16_t    drops;
+    uint16_t    noise;
+    uint8_t     noise_length;
+};
+
+const LinkLevel link_levels[] PROGMEM =
+{
+    {   0,   0,   0,  1 },
+    {  10,   0,   0,  1 },
+    { 100,   0,   0,  1 },
+    {   0, 100,   0,  1 },
+    {   0,   0, 100,  8 },
+    { 100, 100, 100,  8 },
+    { 500, 200, 200, 16 },
+};
+
+void Benchmark::run(Print& out, unsigned long (*to_decimal)(unsigned long))
+{
+    Profiler::startClock();
+    _channel.begin(&_stream);
+    _link_channel.begin(&_faults);
+
+    out.println(F("bench\tname\tops\tcycles/op\tops/s"));
+    busReceive(out);
+    busResync(out);
+    busSend(out);
+    wiegandDecode(out, to_decimal);
+    messageSet(out);
+    linkFaults(out);
+}
+
+void Benchmark::busReceive(Print& out)
+{
+    uint16_t frames;
+    uint32_t cycles = parseTrace(bt_bus_clean, sizeof(bt_bus_clean), bench_passes, frames);
+    result(out, F("bus receive"), frames, cycles);
+}
+
+void Benchmark::busResync(Print& out)
+{
+    uint16_t clean_frames;
+    uint16_t noisy_frames;
+    uint32_t clean = parseTrace(bt_bus_clean, sizeof(bt_bus_clean), bench_passes, clean_frames);
+    uint32_t noisy = parseTrace(bt_bus_noisy, sizeof(bt_bus_noisy), bench_passes, noisy_frames);
+
+    // cost of every noise byte (frames of both traces are the same)
+    uint16_t noise = (sizeof(bt_bus_noisy) - sizeof(bt_bus_clean)) * bench_passes;
+    result(out, F("bus resync (per noise byte)"), noise, noisy > clean ? noisy - clean : 0);
+
+    out.print(F("bench\tbus resync lost frames\t"));
+    out.print(clean_frames - noisy_frames);
+    out.print('/');
+    out.println(clean_frames);
+}
+
+void Benchmark::busSend(Print& out)
+{
+    _stream.begin(nullptr, 0);
+    uint16_t frames = sizeof(bt_bus_clean) / bench_frame * bench_passes;
+
+    uint32_t start = Profiler::cycles();
+    for (uint16_t i = 0; i < frames; i++)
+    {
+        memcpy_P(&_message, bt_bus_clean + (i % (sizeof(bt_bus_clean) / bench_frame)) * bench_frame + 3, sizeof(Message));
+        _channel.send(_message);
+    }
+    uint32_t cycles = Profiler::cycles() - start;
+
+    result(out, F("bus send"), frames, cycles);
+}
+
+void Benchmark::wiegandDecode(Print& out, unsigned long (*to_decimal)(unsigned long))
+{
+    uint32_t bits = 0;
+    uint32_t bit_cycles = 0;
+    uint16_t frames = 0;
+    uint32_t frame_cycles = 0;
+    uint16_t cards = 0;
+    uint32_t decimal_cycles = 0;
+
+    WiegandReader reader;
+
+    for (uint8_t pass = 0; pass < bench_passes; pass++)
+    {
+        for (uint8_t i = 0; i < sizeof(bt_swipes) / sizeof(BenchSwipe); i++)
+        {
+            BenchSwipe swipe;
+            memcpy_P(&swipe, &bt_swipes[i], sizeof(BenchSwipe));
+
+            // pulses as they come from reader head: leading parity, data (msb first), trailing parity
+            uint32_t start = Profiler::cycles();
+            for (uint8_t b = 0; b < swipe.bits; b++)
+            {
+                bool one;
+                if (swipe.bits == 34 && b == 0)
+                    one = swipe.parity & 0x02;
+                else if (swipe.bits == 34 && b == 33)
+                    one = swipe.parity & 0x01;
+                else
+                    one = (swipe.data >> (swipe.bits == 34 ? 32 - b : swipe.bits - 1 - b)) & 1;
+
+                reader.pulse(one);
+            }
+            bit_cycles += Profiler::cycles() - start;
+            bits += swipe.bits;
+
+            // frame is finished (the same as after 25 ms of silence)
+            start = Profiler::cycles();
+            bool available = reader.decode();
+            frame_cycles += Profiler::cycles() - start;
+            frames++;
+
+            if (available)
+            {
+                start = Profiler::cycles();
+                to_decimal(reader.getCode());
+                decimal_cycles += Profiler::cycles() - start;
+                cards++;
+            }
+        }
+    }
+
+    result(out, F("wiegand bit"), bits, bit_cycles);
+    result(out, F("WiegandReader::decode"), frames, frame_cycles);
+    result(out, F("wiegandToDecimal"), cards, decimal_cycles);
+}
+
+void Benchmark::messageSet(Print& out)
+{
+    uint16_t calls = sizeof(bt_swipes) / sizeof(BenchSwipe) * bench_passes;
+
+    uint32_t start = Profiler::cycles();
+    for (uint16_t i = 0; i < calls; i++)
+    {
+        _message.set(i, pgm_read_dword(&bt_swipes[i % (sizeof(bt_swipes) / sizeof(BenchSwipe))].data), i & 0x07, 0);
+    }
+    uint32_t cycles = Profiler::cycles() - start;
+
+    result(out, F("Message::set"), calls, cycles);
+}
+
+void Benchmark::linkFaults(Print& out)
+{
+    out.println(F("link\tbit err\tdrops\tnoise\tgoodput %\tfalse acc\tresync avg\tresync max\tworst cycles"));
+
+    for (uint8_t i = 0; i < sizeof(link_levels) / sizeof(LinkLevel); i++)
+    {
+        LinkLevel level;
+        memcpy_P(&level, &link_levels[i], sizeof(LinkLevel));
+
+        _source.begin(link_device);
+        _faults.begin(&_source, level.bit_errors, level.drops, level.noise, level.noise_length, i + 1);
+
+        uint16_t good = 0;
+        uint16_t false_accepts = 0;
+        uint32_t worst = 0;
+        uint32_t resync_total = 0;
+        uint32_t resync_max = 0;
+        uint16_t resyncs = 0;
+        uint32_t handled_fault = 0;
+
+        while (_source.frames() < link_frames)
+        {
+            uint32_t start = Profiler::cycles();
+            const Message* received = _link_channel.receive();
+            uint32_t cycles = Profiler::cycles() - start;
+            if (cycles > worst)
+                worst = cycles;
+
+            if (!received)
+                continue;
+
+            if (!_source.valid(*received))
+            {
+                false_accepts++;
+                continue;
+            }
+            good++;
+
+            // first good frame after fault: bytes passed since fault is resync latency
+            if (_faults.faults() > 0 && _faults.lastFault() != handled_fault)
+            {
+                uint32_t latency = _faults.position() - _faults.lastFault();
+                resync_total += latency;
+                if (latency > resync_max)
+                    resync_max = latency;
+                resyncs++;
+                handled_fault = _faults.lastFault();
+            }
+        }
+
+        out.print(F("link\t"));
+        out.print(level.bit_errors);
+        out.print('\t');
+        out.print(level.drops);
+        out.print('\t');
+        out.print(level.noise);
+        out.print('\t');
+        out.print(good * 100UL / _source.frames());
+        out.print('\t');
+        out.print(false_accepts);
+        out.print('\t');
+        out.print(resyncs ? resync_total / resyncs : 0);
+        out.print('\t');
+        out.print(resync_max);
+        out.print('\t');
+        out.println(worst);
+    }
+}
+
+uint32_t Benchmark::parseTrace(const uint8_t* trace, uint16_t length, uint8_t passes, uint16_t& frames)
+{
+    frames = 0;
+    uint32_t cycles = 0;
+
+    for (uint8_t pass = 0; pass < passes; pass++)
+    {
+        _stream.begin(trace, length);
+
+        uint32_t start = Profiler::cycles();
+        while (_stream.available())
+        {
+            if (_channel.receive())
+                frames++;
+            // less than header left: parser waits for more data
+            else if (_stream.available() < 3)
+                break;
+        }
+        cycles += Profiler::cycles() - start;
+    }
+
+    return cycles;
+}
+
+void Benchmark::result(Print& out, const __FlashStringHelper* name, uint32_t ops, uint32_t cycles)
+{
+    out.print(F("bench\t"));
+    out.print(name);
+    out.print('\t');
+    out.print(ops);
+    out.print('\t');
+    if (ops == 0 || cycles == 0)
+    {
+        out.println(F("-\t-"));
+        return;
+    }
+    out.print(cycles / ops);
+    out.print('\t');
+    out.println((uint32_t)((float)ops * F_CPU / cycles));
+}
+
+void FrameSource::begin(unsigned short device_id)
+{
+    _device_id = device_id;
+    _number = 0;
+    _position = sizeof(_frame);
+}
+
+bool FrameSource::valid(const Message& message)
+{
+    return message.device_id == _device_id
+        && message.card_id > 0
+        && message.card_id <= _number
+        && message.state_id == (message.card_id & 0x07)
+        && message.other_id == (unsigned short)(message.card_id * 40503);
+}
+
+uint32_t FrameSource::frames()
+{
+    return _position >= sizeof(_frame) ? _number : _number - 1;
+}
+
+int FrameSource::available()
+{
+    return sizeof(_frame);
+}
+
+int FrameSource::read()
+{
+    if (_position >= sizeof(_frame))
+        build();
+    return _frame[_position++];
+}
+
+int FrameSource::peek()
+{
+    if (_position >= sizeof(_frame))
+        build();
+    return _frame[_position];
+}
+
+size_t FrameSource::write(uint8_t)
+{
+    return 1;
+}
+
+void FrameSource::build()
+{
+    _number++;
+
+    Message message;
+    message.set(_device_id, _number, _number & 0x07, (unsigned short)(_number * 40503));
+
+    // the same layout as Channel::send()
+    uint8_t checksum = sizeof(Message);
+    _frame[0] = 0x06;
+    _frame[1] = 0x85;
+    _frame[2] = sizeof(Message);
+    memcpy(_frame + 3, &message, sizeof(Message));
+    for (uint8_t i = 0; i < sizeof(Message); i++)
+        checksum ^= _frame[3 + i];
+    _frame[sizeof(_frame) - 1] = checksum;
+    _position = 0;
+}
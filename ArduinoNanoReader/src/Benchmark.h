@@ -0,0 +1,81 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <Arduino.h>
+#include <Channel.h>
+#include <FaultStream.h>
+#include <MemoryStream.h>
+#include <Message.h>
+
+// endless stream of valid bus frames (back to back) with known content: card_id - frame number,
+// state_id and other_id are derived from it, so damaged frame accepted by parser can be detected
+class FrameSource : public Stream
+{
+public:
+    void begin(unsigned short device_id);
+
+    // true if message has content of one of generated frames
+    bool valid(const Message& message);
+
+    // amount of completely generated frames
+    uint32_t frames();
+
+    int available();
+    int read();
+    int peek();
+    size_t write(uint8_t);
+    using Print::write;
+
+private:
+    // build next frame to buffer
+    void build();
+
+    unsigned short  _device_id = 0;
+    uint32_t        _number = 0;
+    uint8_t         _frame[sizeof(Message) + 4];
+    uint8_t         _position = sizeof(Message) + 4;
+};
+
+// throughput benchmarks of decoding and protocol hot paths. fed with recorded traces (BenchTraces.h),
+// timed with Timer1 cycles. prints one line per benchmark: name, operations, cycles per operation, operations per second
+class Benchmark
+{
+public:
+    // run all benchmarks. to_decimal - card code conversion used by firmware
+    void run(Print& out, unsigned long (*to_decimal)(unsigned long));
+
+private:
+    // frames per second parsed by Channel::receive() from clean bus trace
+    void busReceive(Print& out);
+
+    // extra cycles spent by Channel::receive() on resync after line noise
+    void busResync(Print& out);
+
+    // frames per second built by Channel::send() (checksum + stream writes)
+    void busSend(Print& out);
+
+    // wiegand bits capture and WiegandReader::decode() per frame
+    void wiegandDecode(Print& out, unsigned long (*to_decimal)(unsigned long));
+
+    // Message::set() calls per second
+    void messageSet(Print& out);
+
+    // Channel::receive() on damaged line: goodput, false accepts, resync latency, worst cycles per call
+    void linkFaults(Print& out);
+
+    // parses whole trace passes times, returns cycles spent. frames - amount of received frames
+    uint32_t parseTrace(const uint8_t* trace, uint16_t length, uint8_t passes, uint16_t& frames);
+
+    // prints result line
+    void result(Print& out, const __FlashStringHelper* name, uint32_t ops, uint32_t cycles);
+
+    Message         _message;
+    Channel<Message> _channel;
+    MemoryStream    _stream;
+
+    Channel<Message> _link_channel;             // parser over damaged line
+    FrameSource     _source;
+    FaultStream     _faults;
+};
+
+#endif
@@ -0,0 +1,136 @@
+#include "CardFilter.h"
+
+void CardFilter::begin(int address)
+{
+    _address = address;
+    if (EEPROM.read(_address) != FILTER_MAGIC)
+        clear();
+}
+
+bool CardFilter::contains(unsigned long card_id)
+{
+    uint16_t f = fingerprint(card_id);
+    uint8_t b = bucket(card_id);
+    return find(b, f) >= 0 || find(alternate(b, f), f) >= 0;
+}
+
+bool CardFilter::add(unsigned long card_id)
+{
+    uint16_t f = fingerprint(card_id);
+    uint8_t b1 = bucket(card_id);
+    uint8_t b2 = alternate(b1, f);
+
+    // the same fingerprint is stored once, repeated updates do not fill filter
+    if (find(b1, f) >= 0 || find(b2, f) >= 0)
+        return true;
+
+    int8_t free = find(b1, 0);
+    if (free >= 0)
+    {
+        write(b1, free, f);
+        return true;
+    }
+    free = find(b2, 0);
+    if (free >= 0)
+    {
+        write(b2, free, f);
+        return true;
+    }
+
+    // both buckets are full: move fingerprints to their alternate buckets
+    uint8_t b = (f & 1) ? b1 : b2;
+    for (uint8_t kick = 0; kick < FILTER_KICKS; kick++)
+    {
+        uint8_t index = _victim;
+        _victim = (_victim + 1) % FILTER_SLOTS;
+
+        uint16_t evicted = read(b, index);
+        write(b, index, f);
+        f = evicted;
+        b = alternate(b, f);
+
+        free = find(b, 0);
+        if (free >= 0)
+        {
+            write(b, free, f);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CardFilter::remove(unsigned long card_id)
+{
+    uint16_t f = fingerprint(card_id);
+    uint8_t b = bucket(card_id);
+    int8_t index = find(b, f);
+    if (index < 0)
+    {
+        b = alternate(b, f);
+        index = find(b, f);
+    }
+    if (index < 0)
+        return false;
+
+    write(b, index, 0);
+    return true;
+}
+
+void CardFilter::clear()
+{
+    for (int i = 1; i < FILTER_SIZE; i++)
+        EEPROM.update(_address + i, 0);
+    EEPROM.update(_address, FILTER_MAGIC);
+}
+
+uint16_t CardFilter::fingerprint(unsigned long card_id)
+{
+    // murmur3 finalizer: every bit of card affects every bit of fingerprint
+    uint32_t h = card_id;
+    h ^= h >> 16;
+    h *= 0x85EBCA6B;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35;
+    h ^= h >> 16;
+    uint16_t f = h >> 16;
+    return f != 0 ? f : 1;
+}
+
+uint8_t CardFilter::bucket(unsigned long card_id)
+{
+    return (uint8_t)((card_id * 2654435761UL) >> 24) & (FILTER_BUCKETS - 1);
+}
+
+uint8_t CardFilter::alternate(uint8_t bucket, uint16_t fingerprint)
+{
+    // xor keeps alternate of alternate equal to original bucket
+    return (bucket ^ (uint8_t)((uint16_t)(fingerprint * 0x5BD1U) >> 8)) & (FILTER_BUCKETS - 1);
+}
+
+int CardFilter::slot(uint8_t bucket, uint8_t index)
+{
+    return _address + 1 + (bucket * FILTER_SLOTS + index) * 2;
+}
+
+uint16_t CardFilter::read(uint8_t bucket, uint8_t index)
+{
+    int address = slot(bucket, index);
+    return EEPROM.read(address) | ((uint16_t)EEPROM.read(address + 1) << 8);
+}
+
+void CardFilter::write(uint8_t bucket, uint8_t index, uint16_t fingerprint)
+{
+    int address = slot(bucket, index);
+    EEPROM.update(address, fingerprint & 0xFF);
+    EEPROM.update(address + 1, fingerprint >> 8);
+}
+
+int8_t CardFilter::find(uint8_t bucket, uint16_t fingerprint)
+{
+    for (uint8_t i = 0; i < FILTER_SLOTS; i++)
+    {
+        if (read(bucket, i) == fingerprint)
+            return i;
+    }
+    return -1;
+}
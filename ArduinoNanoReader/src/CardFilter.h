@@ -0,0 +1,57 @@
+#ifndef CARD_FILTER_H
+#define CARD_FILTER_H
+
+#include <Arduino.h>
+#include <EEPROM.h>
+
+#define FILTER_MAGIC    0xCF                    // marks initialized filter area
+#define FILTER_BUCKETS  64                      // buckets (power of 2)
+#define FILTER_SLOTS    4                       // fingerprints in bucket
+#define FILTER_KICKS    32                      // max relocations on insert
+#define FILTER_SIZE     (1 + FILTER_BUCKETS * FILTER_SLOTS * 2)     // bytes of EEPROM
+
+// cuckoo filter of blocked card ids in EEPROM (16-bit fingerprints, ~240 cards in 513 bytes, ~0.01% false positives).
+// unlike bloom filter it supports removal, so gateway updates it card by card. when insert fails some
+// fingerprint is lost: that card only goes to server again, so failures are safe
+class CardFilter
+{
+public:
+    // use EEPROM from address (cleared if it does not contain filter yet)
+    void begin(int address);
+
+    // returns true if card is probably in filter (false - surely not)
+    bool contains(unsigned long card_id);
+
+    // add card. returns false if filter is full (one fingerprint was lost)
+    bool add(unsigned long card_id);
+
+    // remove card. returns false if it was not in filter
+    bool remove(unsigned long card_id);
+
+    // remove all cards
+    void clear();
+
+private:
+    // fingerprint of card (never 0, 0 marks free slot)
+    uint16_t fingerprint(unsigned long card_id);
+
+    // first bucket of card
+    uint8_t bucket(unsigned long card_id);
+
+    // second bucket of fingerprint (alternate of the other one)
+    uint8_t alternate(uint8_t bucket, uint16_t fingerprint);
+
+    // EEPROM address of slot in bucket
+    int slot(uint8_t bucket, uint8_t index);
+
+    uint16_t read(uint8_t bucket, uint8_t index);
+    void write(uint8_t bucket, uint8_t index, uint16_t fingerprint);
+
+    // find fingerprint in bucket. returns slot index or -1
+    int8_t find(uint8_t bucket, uint16_t fingerprint);
+
+    int             _address = 0;
+    uint8_t         _victim = 0;                // slot evicted by next relocation
+};
+
+#endif
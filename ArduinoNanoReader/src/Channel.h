@@ -0,0 +1,107 @@
+#ifndef CHANNEL_H
+#define CHANNEL_H
+
+#include <Arduino.h>
+
+#define CHANNEL_HEADER_0    0x06                // first byte of frame
+#define CHANNEL_HEADER_1    0x85                // second byte of frame
+
+// typed frames over bus stream: 0x06 0x85, size, bytes of value, xor checksum of size and bytes
+// (the same wire format as EasyTransfer had). buffers are static: frame is received straight into the back one
+// of two and handed to consumer without copying, so the next frame does not overwrite the one being handled
+template <typename T>
+class Channel
+{
+    static_assert(sizeof(T) > 0 && sizeof(T) < 255, "Channel: size of frame is one byte");
+    static_assert(__is_trivially_copyable(T), "Channel: value is sent as bytes");
+    static_assert(__is_standard_layout(T), "Channel: value needs the same layout on both ends");
+
+public:
+    // stream of bus (RS485 serial or trace stream)
+    void begin(Stream* stream);
+
+    // send frame with value
+    void send(const T& value);
+
+    // parse bytes came from stream. returns received frame, nullptr if there is no complete one yet.
+    // frame stays untouched until receive() returns the next one
+    const T* receive();
+
+private:
+    Stream*         _stream = nullptr;
+    T               _frames[2];                 // front (handed to consumer) and back (being received)
+    uint8_t         _back = 0;
+    bool            _header = false;            // header of frame is found, bytes of value come
+    uint8_t         _index = 0;                 // received bytes of value
+    uint8_t         _checksum = 0;              // xor of size and received bytes
+};
+
+template <typename T>
+void Channel<T>::begin(Stream* stream)
+{
+    _stream = stream;
+    _header = false;
+}
+
+template <typename T>
+void Channel<T>::send(const T& value)
+{
+    const uint8_t* bytes = (const uint8_t*)&value;
+    uint8_t checksum = sizeof(T);
+
+    _stream->write(CHANNEL_HEADER_0);
+    _stream->write(CHANNEL_HEADER_1);
+    _stream->write((uint8_t)sizeof(T));
+    for (uint8_t i = 0; i < sizeof(T); i++)
+    {
+        checksum ^= bytes[i];
+        _stream->write(bytes[i]);
+    }
+    _stream->write(checksum);
+}
+
+template <typename T>
+const T* Channel<T>::receive()
+{
+    // header: junk before it is skipped while at least a header is left, frames of other size are dropped
+    if (!_header)
+    {
+        if (_stream->available() < 3)
+            return nullptr;
+        while (_stream->read() != CHANNEL_HEADER_0)
+        {
+            if (_stream->available() < 3)
+                return nullptr;
+        }
+        if (_stream->read() != CHANNEL_HEADER_1 || _stream->read() != sizeof(T))
+            return nullptr;
+
+        _header = true;
+        _index = 0;
+        _checksum = sizeof(T);
+    }
+
+    uint8_t* bytes = (uint8_t*)&_frames[_back];
+    while (_stream->available())
+    {
+        uint8_t c = _stream->read();
+        if (_index < sizeof(T))
+        {
+            bytes[_index++] = c;
+            _checksum ^= c;
+            continue;
+        }
+
+        // checksum byte ends frame, damaged one is dropped (back buffer is reused)
+        _header = false;
+        if (c != _checksum)
+            return nullptr;
+
+        const T* frame = &_frames[_back];
+        _back ^= 1;
+        return frame;
+    }
+    return nullptr;
+}
+
+#endif
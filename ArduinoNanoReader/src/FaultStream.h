@@ -0,0 +1,123 @@
+#ifndef FAULT_STREAM_H
+#define FAULT_STREAM_H
+
+#include <Arduino.h>
+
+// stream wrapper which damages bytes read from source: flips bits, drops bytes and inserts noise bursts.
+// probabilities are set per 10000 read bytes, random generator is seeded, so every run is repeatable
+class FaultStream : public Stream
+{
+public:
+    void begin(Stream* source, uint16_t bit_errors, uint16_t drops, uint16_t noise, uint8_t noise_length, uint32_t seed = 1)
+    {
+        _source = source;
+        _bit_errors = bit_errors;
+        _drops = drops;
+        _noise = noise;
+        _noise_length = noise_length > 0 ? noise_length : 1;
+        _noise_left = 0;
+        _seed = seed ? seed : 1;
+        _position = 0;
+        _faults = 0;
+        _last_fault = 0;
+    }
+
+    int available()
+    {
+        return _noise_left + _source->available();
+    }
+
+    int read()
+    {
+        _position++;
+
+        // noise burst between bytes of source
+        if (_noise_left == 0 && chance(_noise))
+        {
+            _noise_left = 1 + next() % _noise_length;
+            fault();
+        }
+        if (_noise_left > 0)
+        {
+            _noise_left--;
+            return next() & 0xFF;
+        }
+
+        int value = _source->read();
+        if (value >= 0 && chance(_drops))
+        {
+            fault();
+            value = _source->read();
+        }
+        if (value >= 0 && chance(_bit_errors))
+        {
+            fault();
+            value ^= 1 << (next() & 0x07);
+        }
+        return value;
+    }
+
+    int peek()
+    {
+        return _noise_left > 0 ? -1 : _source->peek();
+    }
+
+    size_t write(uint8_t value)
+    {
+        return _source->write(value);
+    }
+
+    using Print::write;
+
+    // bytes read since begin()
+    uint32_t position()
+    {
+        return _position;
+    }
+
+    // amount of injected faults
+    uint32_t faults()
+    {
+        return _faults;
+    }
+
+    // position of last injected fault
+    uint32_t lastFault()
+    {
+        return _last_fault;
+    }
+
+private:
+    // xorshift32
+    uint32_t next()
+    {
+        _seed ^= _seed << 13;
+        _seed ^= _seed >> 17;
+        _seed ^= _seed << 5;
+        return _seed;
+    }
+
+    bool chance(uint16_t per_10000)
+    {
+        return per_10000 > 0 && (next() % 10000) < per_10000;
+    }
+
+    void fault()
+    {
+        _faults++;
+        _last_fault = _position;
+    }
+
+    Stream*     _source = nullptr;
+    uint16_t    _bit_errors = 0;
+    uint16_t    _drops = 0;
+    uint16_t    _noise = 0;
+    uint8_t     _noise_length = 1;
+    uint8_t     _noise_left = 0;
+    uint32_t    _seed = 1;
+    uint32_t    _position = 0;
+    uint32_t    _faults = 0;
+    uint32_t    _last_fault = 0;
+};
+
+#endif
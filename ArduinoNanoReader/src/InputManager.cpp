@@ -0,0 +1,141 @@
+#include "InputManager.h"
+
+InputManager* InputManager::_manager = nullptr;
+
+void InputManager::begin()
+{
+    uint8_t sreg = SREG;
+    cli();
+    _manager = this;
+
+    // timer 0 runs for millis() already (clk / 64, overflow every 1.024 ms). interrupt is enabled by edges only
+    OCR0B = INPUT_TICK_PHASE;
+    TIMSK0 &= ~_BV(OCIE0B);
+    SREG = sreg;
+}
+
+uint8_t InputManager::add(uint8_t pin, bool active_low, uint8_t debounce)
+{
+    if (_count == INPUT_PINS)
+        return _count - 1;
+
+    pinMode(pin, INPUT_PULLUP);
+
+    Input& input = _inputs[_count];
+    input.port = portInputRegister(digitalPinToPort(pin));
+    input.mask = digitalPinToBitMask(pin);
+    input.active_low = active_low;
+    input.debounce = debounce;
+    input.raw = *input.port & input.mask;
+    input.settle = 0;
+    input.active = level(input, input.raw);
+    input.edge = 0;
+
+    uint8_t sreg = SREG;
+    cli();
+    _count++;
+    *digitalPinToPCMSK(pin) |= _BV(digitalPinToPCMSKbit(pin));
+    *digitalPinToPCICR(pin) |= _BV(digitalPinToPCICRbit(pin));
+    SREG = sreg;
+    return _count - 1;
+}
+
+bool InputManager::active(uint8_t input)
+{
+    return _inputs[input].active;
+}
+
+bool InputManager::pop(Event& event)
+{
+    if (_size == 0)
+        return false;
+
+    uint8_t sreg = SREG;
+    cli();
+    event = _events[_head];
+    _head = (_head + 1) % INPUT_EVENTS;
+    _size--;
+    SREG = sreg;
+    return true;
+}
+
+uint8_t InputManager::dropped()
+{
+    return _dropped;
+}
+
+void InputManager::pinChange(volatile uint8_t* port, uint8_t pins)
+{
+    InputManager* m = _manager;
+    if (m == nullptr)
+        return;
+
+    for (uint8_t i = 0; i < m->_count; i++)
+    {
+        Input& input = m->_inputs[i];
+        uint8_t raw = pins & input.mask;
+        if (input.port != port || raw == input.raw)
+            continue;
+
+        // every bounce restarts settling, time of event is the first edge
+        input.raw = raw;
+        if (input.settle == 0)
+        {
+            input.edge = millis();
+            m->_settling++;
+        }
+        input.settle = input.debounce;
+    }
+
+    // tick runs from now on while something settles
+    if (m->_settling > 0 && !(TIMSK0 & _BV(OCIE0B)))
+    {
+        TIFR0 = _BV(OCF0B);
+        TIMSK0 |= _BV(OCIE0B);
+    }
+}
+
+void InputManager::tick()
+{
+    InputManager* m = _manager;
+
+    for (uint8_t i = 0; i < m->_count; i++)
+    {
+        Input& input = m->_inputs[i];
+        if (input.settle == 0 || --input.settle > 0)
+            continue;
+
+        // glitch which came back to debounced level is not an event
+        m->_settling--;
+        bool active = m->level(input, *input.port & input.mask);
+        if (active != input.active)
+        {
+            input.active = active;
+            m->push(i, active, input.edge);
+        }
+    }
+
+    if (m->_settling == 0)
+        TIMSK0 &= ~_BV(OCIE0B);
+}
+
+bool InputManager::level(const Input& input, uint8_t raw)
+{
+    return (raw != 0) != input.active_low;
+}
+
+void InputManager::push(uint8_t input, bool active, uint32_t time)
+{
+    if (_size == INPUT_EVENTS)
+    {
+        _head = (_head + 1) % INPUT_EVENTS;
+        _size--;
+        _dropped++;
+    }
+
+    Event& event = _events[(_head + _size) % INPUT_EVENTS];
+    event.input = input;
+    event.active = active;
+    event.time = time;
+    _size++;
+}
@@ -0,0 +1,77 @@
+#ifndef INPUT_MANAGER_H
+#define INPUT_MANAGER_H
+
+#include <Arduino.h>
+
+#define INPUT_PINS      4                       // max inputs watched
+#define INPUT_EVENTS    8                       // events waiting for loop (the oldest is dropped when queue is full)
+#define INPUT_TICK_PHASE 128                    // timer 0 count of tick (half way between overflows of millis())
+
+// contacts (reed switch, exit button, tamper) watched by pin change interrupts instead of polling. edge of pin
+// starts debounce on compare B of timer 0: it counts for millis() anyway, compare match comes every 1.024 ms and is
+// enabled only while some input settles (mode and count of timer 0 are not touched; timer 1 is taken by profiler,
+// timer 2 by NeoSWSerial). level held for debounce time becomes event with time of its first edge.
+// ISR of every port has to call pinChange(), ISR(TIMER0_COMPB_vect) - tick()
+class InputManager
+{
+public:
+    struct Event
+    {
+        uint8_t         input;                  // index of input (order of add())
+        bool            active;                 // debounced level
+        uint32_t        time;                   // millis() of first edge
+    };
+
+    // set compare B of timer 0 for debounce ticks
+    void begin();
+
+    // set pin as input with pull-up and enable pin change interrupt for it. active_low - contact closed to ground
+    // is active. debounce - ticks (about ms) of stable level. returns index of input
+    uint8_t add(uint8_t pin, bool active_low, uint8_t debounce);
+
+    // debounced level of input
+    bool active(uint8_t input);
+
+    // take oldest event. returns false if queue is empty
+    bool pop(Event& event);
+
+    // events lost because of full queue
+    uint8_t dropped();
+
+    // handle pin change of port (input register) for all inputs on it. call from ISR(PCINTx_vect)
+    static void pinChange(volatile uint8_t* port, uint8_t pins);
+
+    // debounce tick. call from ISR(TIMER0_COMPB_vect)
+    static void tick();
+
+private:
+    struct Input
+    {
+        volatile uint8_t*   port;               // input register of pin
+        uint8_t             mask;               // bit mask of pin in port
+        bool                active_low;
+        uint8_t             debounce;
+        uint8_t             raw;                // last seen state of pin (masked)
+        uint8_t             settle;             // ticks left till level is taken (0 - stable)
+        bool                active;             // debounced level
+        uint32_t            edge;               // time of first edge of settling
+    };
+
+    // level of pin state
+    bool level(const Input& input, uint8_t raw);
+
+    void push(uint8_t input, bool active, uint32_t time);
+
+    Input               _inputs[INPUT_PINS];
+    uint8_t             _count = 0;
+    uint8_t             _settling = 0;          // inputs with debounce running
+
+    Event               _events[INPUT_EVENTS];
+    volatile uint8_t    _head = 0;              // oldest event
+    volatile uint8_t    _size = 0;
+    volatile uint8_t    _dropped = 0;
+
+    static InputManager*    _manager;
+};
+
+#endif
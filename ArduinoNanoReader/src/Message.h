@@ -1,14 +1,17 @@
+#ifndef MESSAGE_H
+#define MESSAGE_H
+
 #include <Arduino.h>
 
 #define DFLT_MSG_VAL 0
 
-// struct for exchanging data via EasyTransfer
-struct Message
+// struct for exchanging data via Channel (bus frame). packed: the same layout on host build (tools of host/)
+struct __attribute__((packed)) Message
 {
-	unsigned short	device_id 	= DFLT_MSG_VAL;	// reader device id
-	unsigned long	card_id 	= DFLT_MSG_VAL;	    // read card id
-	unsigned short	state_id 	= DFLT_MSG_VAL;	// message state 
-	unsigned short	other_id 	= DFLT_MSG_VAL;	// other information
+	uint16_t		device_id 	= DFLT_MSG_VAL;	// reader device id
+	uint32_t		card_id 	= DFLT_MSG_VAL;	    // read card id
+	uint16_t		state_id 	= DFLT_MSG_VAL;	// message state 
+	uint16_t		other_id 	= DFLT_MSG_VAL;	// other information
 
 	// set message data
 	void set(unsigned short device_id = DFLT_MSG_VAL, unsigned long card_id = DFLT_MSG_VAL,
@@ -26,3 +29,10 @@ struct Message
 		set();
 	}
 };
+
+// frame layout is the same on reader and gateway (no padding, little-endian)
+static_assert(sizeof(Message) == 10, "Message: frame size changed");
+static_assert(offsetof(Message, card_id) == 2 && offsetof(Message, state_id) == 6 && offsetof(Message, other_id) == 8,
+	"Message: frame layout changed");
+
+#endif
@@ -0,0 +1,113 @@
+#include "Profiler.h"
+
+volatile uint16_t Profiler::_overflows = 0;
+
+void Profiler::begin()
+{
+    startClock();
+
+    // measuring empty interval gives cost of profiler itself
+    _overhead = 0;
+    reset();
+    start(0);
+    stop(0);
+    _overhead = _slots[0].min;
+    reset();
+}
+
+void Profiler::startClock()
+{
+    uint8_t sreg = SREG;
+    cli();
+    TCCR1A = 0;                                 // normal mode, no output compare
+    TCCR1B = _BV(CS10);                         // clock source without prescaler
+    TCNT1 = 0;
+    TIFR1 = _BV(TOV1);
+    TIMSK1 = _BV(TOIE1);
+    _overflows = 0;
+    SREG = sreg;
+}
+
+uint32_t Profiler::cycles()
+{
+    uint8_t sreg = SREG;
+    cli();
+    uint16_t low = TCNT1;
+    uint16_t high = _overflows;
+    // overflow happened but interrupt is not handled yet
+    if ((TIFR1 & _BV(TOV1)) && low < 0x8000)
+        high++;
+    SREG = sreg;
+    return ((uint32_t)high << 16) | low;
+}
+
+void Profiler::start(uint8_t slot)
+{
+    _started[slot] = cycles();
+}
+
+void Profiler::stop(uint8_t slot)
+{
+    uint32_t passed = cycles() - _started[slot];
+    passed = passed > _overhead ? passed - _overhead : 0;
+
+    Slot& s = _slots[slot];
+    s.count++;
+    s.total += passed;
+    if (passed < s.min)
+        s.min = passed;
+    if (passed > s.max)
+        s.max = passed;
+}
+
+void Profiler::reset()
+{
+    for (uint8_t i = 0; i < PROFILER_SLOTS; i++)
+    {
+        _slots[i].count = 0;
+        _slots[i].total = 0;
+        _slots[i].min = 0xFFFFFFFF;
+        _slots[i].max = 0;
+    }
+}
+
+void Profiler::report(Print& out, const char* const* names, const uint32_t* baselines, uint8_t count, uint8_t tolerance)
+{
+    for (uint8_t i = 0; i < count && i < PROFILER_SLOTS; i++)
+    {
+        const Slot& s = _slots[i];
+        if (s.count == 0)
+            continue;
+
+        uint32_t mean = s.total / s.count;
+        uint32_t base = pgm_read_dword(&baselines[i]);
+
+        out.print(F("prof\t"));
+        out.print((const __FlashStringHelper*)pgm_read_ptr(&names[i]));
+        out.print(F("\tn="));
+        out.print(s.count);
+        out.print(F("\tmin="));
+        out.print(s.min);
+        out.print(F("\tavg="));
+        out.print(mean);
+        out.print(F("\tmax="));
+        out.print(s.max);
+        out.print(F("\tbase="));
+        out.print(base);
+
+        if (base == 0)
+        {
+            out.println(F("\t-"));
+        }
+        else if (mean > base + (uint32_t)base * tolerance / 100)
+        {
+            out.print(F("\tSLOW +"));
+            out.print((mean - base) * 100 / base);
+            out.println('%');
+        }
+        else
+        {
+            out.println(F("\tok"));
+        }
+    }
+}
@@ -1,3 +1,6 @@
+#ifndef TIMER_H
+#define TIMER_H
+
 #include <Arduino.h>
 
 class Timer
@@ -34,3 +37,5 @@ private:
 	uint32_t _timer = 0;
 	uint32_t _period = 0;
 };
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef TRACE_STREAM_H
+#define TRACE_STREAM_H
+
+#include <Arduino.h>
+
+#define TRACE_BURST     16                      // max bytes in one trace record
+#define TRACE_GAP       2                       // silence on line (ms) which ends a burst record
+#define TRACE_CARRY     2                       // replay: less than frame header (3 bytes) left in record goes to the next one
+
+// stream between Channel and RS485 line for capturing and replaying bus traffic.
+// trace is text, one record per line (can be mixed with debug output, other lines are ignored):
+//   ~<kind><dt>:<data>
+//   kind - 'r' bytes received from line, 't' bytes transmitted to line, 'w' wiegand frame
+//   dt   - milliseconds passed since previous record
+//   data - 'r', 't': bytes in hex; 'w': <bits>:<code>:<reader head>
+// in replay mode records are requested one by one: "~>" line is printed when the next record is expected.
+// records split frames (burst is cut at TRACE_BURST bytes): Channel looks for header only when 3 bytes are available,
+// so in replay the last 1-2 bytes of record waiting for header go in front of the next received record.
+// bytes transmitted in replay are written as 't' records too: bytes of one loop pass (up to TRACE_BURST) in one record
+class TraceStream : public Stream
+{
+public:
+    // pass bytes through line and write them to out (Serial, SD file or any other Print)
+    void record(Stream* line, Print* out);
+
+    // take received bytes and wiegand frames from trace coming from in, keeping original timing
+    // divided by speed. transmitted bytes are written to out as 't' records (for comparing with original)
+    void replay(Stream* in, Print* out, uint8_t speed = 1);
+
+    // write wiegand frame record (record mode)
+    void frame(uint8_t bits, unsigned long code, uint8_t head = 0);
+
+    // returns true, code and reader head of wiegand frame if recorded frame is due (replay mode)
+    bool frame(unsigned long& code, uint8_t& head);
+
+    int available();
+    int read();
+    int peek();
+    size_t write(uint8_t value);
+    using Print::write;
+
+private:
+    enum Parse
+    {
+        p_idle,                                 // waiting for '~'
+        p_kind,
+        p_dt,
+        p_hex,
+        p_bits,
+        p_code,
+        p_head,
+        p_skip,                                 // skipping rest of line
+        p_ready                                 // record parsed and waits for it's time
+    };
+
+    // add byte to current burst record
+    void put(char kind, uint8_t value);
+
+    // write current burst record
+    void flushBurst();
+
+    // write bytes transmitted in replay mode as one record
+    void flushSent();
+
+    // write record line
+    void printRecord(char kind, uint32_t dt, const uint8_t* bytes, uint8_t length);
+
+    // parse replay input until record is ready. returns true if ready record is due
+    bool pump();
+
+    // returns true if received bytes record is due (replay mode)
+    bool received();
+
+    // mark ready record as consumed and request next one
+    void next();
+
+    Stream*     _line = nullptr;
+    Print*      _out = nullptr;
+    Stream*     _in = nullptr;
+    bool        _replay = false;
+    uint8_t     _speed = 1;
+
+    char        _kind = 0;
+    uint8_t     _burst[TRACE_CARRY + TRACE_BURST];
+    uint8_t     _length = 0;
+    uint8_t     _position = 0;
+    uint32_t    _burst_time = 0;                // record mode: time of burst start
+    uint32_t    _last = 0;                      // time of previous record (replay mode: of previous 't' record)
+
+    Parse       _parse = p_idle;
+    uint32_t    _dt = 0;
+    uint32_t    _clock = 0;                     // replay mode: trace time of current record
+    uint32_t    _start = 0;                     // replay mode: millis() of first record
+    bool        _started = false;
+    uint8_t     _bits = 0;
+    unsigned long _code = 0;
+    uint8_t     _head = 0;
+    int8_t      _nibble = -1;
+    uint8_t     _carry = 0;                     // bytes of previous record in front of _burst
+    bool        _short = false;                 // less than header was available and nothing read since
+
+    uint8_t     _sent[TRACE_BURST];             // replay mode: transmitted bytes not written yet
+    uint8_t     _sent_length = 0;
+};
+
+#endif
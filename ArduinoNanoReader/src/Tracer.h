@@ -0,0 +1,51 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <Arduino.h>
+
+#define TRACER_OPEN     8                       // max transactions open at once (one per reader head)
+
+// stage timestamps of card transactions under compact trace id, printed as text lines (can be mixed with debug output):
+//   $<stage>:<device id>:<trace id>:<micros>[:<state>]
+// trace id is given by reader (other_id of lookup frame) or by gateway if reader did not give one, and goes to server
+// as '&trace='. tools/trace_join.py joins lines of reader, gateway and server into per-transaction latency breakdowns
+class Tracer
+{
+public:
+    // out - where lines go. own - bit of ids given by this device (ids of gateway and readers differ)
+    void begin(Print* out, uint16_t own);
+
+    // transaction of device starts (the previous one of device is abandoned). trace 0 - next own id is given.
+    // returns trace id
+    uint16_t open(unsigned short device_id, uint16_t trace = 0);
+
+    // trace id of open transaction of device (0 - none)
+    uint16_t find(unsigned short device_id);
+
+    // stage of open transaction of device (nothing is printed if there is none)
+    void stage(unsigned short device_id, const __FlashStringHelper* name);
+
+    // last stage of open transaction with its state, transaction is closed
+    void close(unsigned short device_id, const __FlashStringHelper* name, unsigned short state_id);
+
+private:
+    struct Open
+    {
+        unsigned short  device_id;
+        uint16_t        trace;                  // 0 - free slot
+    };
+
+    // open transaction of device or nullptr
+    Open* slot(unsigned short device_id);
+
+    // print stage line without line end
+    void line(const Open& open, const __FlashStringHelper* name);
+
+    Print*          _out = nullptr;
+    uint16_t        _own = 0;
+    uint16_t        _next = 0;
+    Open            _open[TRACER_OPEN];
+    uint8_t         _replace = 0;               // slot taken when all are open
+};
+
+#endif
@@ -0,0 +1,130 @@
+#include "WiegandReader.h"
+
+WiegandReader*  WiegandReader::_readers[WIEGAND_READERS];
+uint8_t         WiegandReader::_count = 0;
+
+// keypad '*' and '#' keys are translated to ASCII ENTER and ESCAPE
+static unsigned long translateKey(uint8_t key)
+{
+    if (key == 0x0b)
+        return 0x0d;
+    if (key == 0x0a)
+        return 0x1b;
+    return key;
+}
+
+void WiegandReader::begin(uint8_t pin_d0, uint8_t pin_d1)
+{
+    pinMode(pin_d0, INPUT);
+    pinMode(pin_d1, INPUT);
+
+    _port = portInputRegister(digitalPinToPort(pin_d0));
+    _d0 = digitalPinToBitMask(pin_d0);
+    _d1 = digitalPinToBitMask(pin_d1);
+    _state = *_port & (_d0 | _d1);
+    _bits = 0;
+
+    uint8_t sreg = SREG;
+    cli();
+    if (_count < WIEGAND_READERS)
+        _readers[_count++] = this;
+    *digitalPinToPCMSK(pin_d0) |= _BV(digitalPinToPCMSKbit(pin_d0));
+    *digitalPinToPCMSK(pin_d1) |= _BV(digitalPinToPCMSKbit(pin_d1));
+    *digitalPinToPCICR(pin_d0) |= _BV(digitalPinToPCICRbit(pin_d0));
+    SREG = sreg;
+}
+
+bool WiegandReader::available()
+{
+    if (_bits == 0)
+        return false;
+
+    uint8_t sreg = SREG;
+    cli();
+    bool ready = millis() - _last_bit > WIEGAND_TIMEOUT;
+    bool valid = ready && decode();
+    SREG = sreg;
+    return valid;
+}
+
+unsigned long WiegandReader::getCode()
+{
+    return _code;
+}
+
+uint8_t WiegandReader::getWiegandType()
+{
+    return _type;
+}
+
+void WiegandReader::pulse(bool one)
+{
+    _high = (_high << 1) | (uint8_t)(_low >> 31);
+    _low = (_low << 1) | one;
+    if (_bits < 0xFF)
+        _bits++;
+    _last_bit = millis();
+}
+
+bool WiegandReader::decode()
+{
+    uint8_t bits = _bits;
+    uint32_t low = _low;
+    uint8_t high = _high;
+    _bits = 0;
+    _low = 0;
+    _high = 0;
+
+    switch (bits)
+    {
+    // cards: data without leading and trailing parity bits
+    case 34:
+        _code = ((uint32_t)high << 31) | (low >> 1);
+        break;
+    case 32:
+        _code = (low & 0x7FFFFFFE) >> 1;
+        break;
+    case 26:
+        _code = (low & 0x1FFFFFE) >> 1;
+        break;
+    case 24:
+        _code = (low & 0x7FFFFE) >> 1;
+        break;
+
+    // keypad with integrity: high nibble is inverted low nibble
+    case 8:
+        if ((low & 0x0F) != (~low >> 4 & 0x0F))
+            return false;
+        _code = translateKey(low & 0x0F);
+        break;
+    // keypad without integrity check
+    case 4:
+        _code = translateKey(low & 0x0F);
+        break;
+
+    // noise
+    default:
+        return false;
+    }
+
+    _type = bits;
+    return true;
+}
+
+void WiegandReader::pinChange(volatile uint8_t* port, uint8_t pins)
+{
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        WiegandReader* r = _readers[i];
+        if (r->_port != port)
+            continue;
+
+        // bit is a low pulse on one of data lines
+        uint8_t fell = r->_state & ~pins;
+        r->_state = pins & (r->_d0 | r->_d1);
+        if (fell & r->_d0)
+            r->pulse(0);
+        if (fell & r->_d1)
+            r->pulse(1);
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef WIEGAND_READER_H
+#define WIEGAND_READER_H
+
+#include <Arduino.h>
+
+#define WIEGAND_READERS 4                       // max amount of readers (heads) on one board
+#define WIEGAND_TIMEOUT 25                      // silence on data lines (ms) which ends a frame
+
+// wiegand decoder of one reader head. every instance has it's own capture buffer, so several heads
+// can be connected to one board. data pins are watched by pin change interrupts: ISR of every port
+// has to call pinChange() (both data pins of one head have to be on the same port)
+class WiegandReader
+{
+public:
+    // set data pins as inputs and enable pin change interrupts for them
+    void begin(uint8_t pin_d0, uint8_t pin_d1);
+
+    // returns true if complete frame was received (code can be taken with getCode())
+    bool available();
+
+    // code of last received frame
+    unsigned long getCode();
+
+    // bit length of last received frame (4, 8 - keypad, 24, 26, 32, 34 - cards)
+    uint8_t getWiegandType();
+
+    // add received bit to capture buffer (called from interrupt)
+    void pulse(bool one);
+
+    // convert captured bits to code regardless of timing. returns true if frame is valid
+    bool decode();
+
+    // handle pin change of port (input register) for all readers on it. call from ISR(PCINTx_vect)
+    static void pinChange(volatile uint8_t* port, uint8_t pins);
+
+private:
+    volatile uint8_t*   _port = nullptr;        // input register of data pins
+    uint8_t             _d0 = 0;                // bit mask of D0 pin in port
+    uint8_t             _d1 = 0;                // bit mask of D1 pin in port
+    uint8_t             _state = 0;             // last state of data pins
+
+    volatile uint32_t   _low = 0;               // last 32 received bits
+    volatile uint8_t    _high = 0;              // bits received before last 32 ones
+    volatile uint8_t    _bits = 0;              // amount of received bits
+    volatile uint32_t   _last_bit = 0;          // time of last received bit
+
+    unsigned long       _code = 0;
+    uint8_t             _type = 0;
+
+    static WiegandReader*   _readers[WIEGAND_READERS];
+    static uint8_t          _count;
+};
+
+#endif
@@ -19,7 +19,7 @@ void WiegandSignal::invoke(Length length, uint8_t count)
     dWrite(zum_pin, state);
 }
 
-void WiegandSignal::update(Length length = s_none, bool zum = true, bool led = true)
+void WiegandSignal::update(Length length, bool zum, bool led)
 {
     // update with periodic signal (without counter)
     if (length != s_none)
@@ -6,13 +6,19 @@
 */
 
 #include <Arduino.h>
+#include <Benchmark.h>
+#include <CardFilter.h>
+#include <Channel.h>
+#include <Tracer.h>
 #include <DIO2.h> 
-#include <EasyTransfer.h>
 #include <EEPROM.h>
+#include <InputManager.h>
 #include <Message.h>
-#include <SoftwareSerial.h>
+#include <Profiler.h>
+#include <NeoSWSerial.h>
 #include <Timer.h>
-#include <Wiegand.h>
+#include <TraceStream.h>
+#include <WiegandReader.h>
 #include <WiegandSignal.h>
 
 #define DEBUG true
@@ -41,6 +47,16 @@ char debug_buffer[64];
 #define NEW_DEV_ID  999
 #define WICKET      true
 #define REED_SWITCH true
+#define PROFILE     false                       // measure cycles of hot paths and print statistics to serial
+#define BENCHMARK   false                       // run benchmarks of decode and protocol paths on start
+#define TRACE_RECORD false                      // write bus bytes and wiegand frames to serial as trace
+#define TRACE_REPLAY false                      // take bus bytes and wiegand frames from trace coming to serial
+#define TRACE_IDS   false                       // give trace id to every card lookup, print its stage timestamps
+#define BLOCK_FILTER false                      // reject blocked cards locally by filter from gateway
+#define JOIN        false                       // register after device id backoff, listening to bus, until master acknowledges
+#define PRIORITY    false                       // apply site-wide commands of master first and acknowledge them
+#define LIVENESS    false                       // heartbeat when idle, "no master" at once when it is not acknowledged
+#define INPUTS      false                       // reed switch, exit button and tamper by interrupts, door events to master
 
 #pragma region GLOBAL_SETTINGS
 
@@ -49,38 +65,51 @@ char debug_buffer[64];
 #define         broadcast_id    999             // id for receiving broadcast messages
 #define         handle_delay    0               // handle received response delay (for skipping default wiegand blink and beep)
 
-unsigned long   device_id       = 803;          // unique ID of reader device
-EasyTransfer    easy_transfer;                  // object for exchanging data using RS485
-Message         message;                        // exchangeable object for EasyTransfer
+unsigned long   device_id       = 803;          // unique ID of reader device (its heads have ids 'head_id(N)')
+Channel<Message> channel;                       // frames exchanged with master via RS485 (static double buffer)
 bool            ethernet_flag   = true;         // flag of ethernet connection (true if connection established)
 
 #pragma endregion //GLOBAL_SETTINGS
 
 #pragma region V_RS485
 
-#define         rs_rx_pin   4                   // receive pin
+#define         rs_rx_pin   4                   // receive pin (has to be on port D, pin change interrupt is shared with wiegand)
 #define         rs_tx_pin   5                   // transmit pin
 #define         rs_baud     9600                // baud rate (speed)
 #define         rs_rspns    1500                // max waiting response time
 
-SoftwareSerial  rs485(rs_rx_pin, rs_tx_pin);    // object for receiving and transmitting data via RS485
+NeoSWSerial     rs485(rs_rx_pin, rs_tx_pin);    // object for receiving and transmitting data via RS485
+uint8_t         rs_rx_state;                    // last level of receive pin (for pin change interrupt)
 bool            rs_flag = true;                 // true if response from master is being receiving
 Timer           rs_wait_timer;                  // timer for waiting respinse from master
 
+#define         rs_retries  2                   // max retries of card lookup after "busy" answer of master
+Timer           rs_retry_timer;                 // lookup retry timer (period is hint of master)
+unsigned short  rs_retry_device = 0;            // device id (reader head) of lookup to retry
+unsigned long   rs_retry_card = 0;              // card of lookup to retry
+uint8_t         rs_retry_count = 0;             // retries done for last read card
+
 #pragma endregion //V_RS485
 
 #pragma region V_WIEGAND
 
-#define         w_rx_pin    2                   // receive pin
-#define         w_tx_pin    3                   // transmit pin
-#define         w_zum_pin   6                   // built-in zummer pin
-#define         w_led_pin   7                   // built-in led pin
+#define         w_heads     2                   // amount of connected reader heads (1-3)
+#define         w_head_ids  4                   // device ids reserved for every reader (heads of readers never share id)
+#define         head_id(head)   ((unsigned short)(device_id * w_head_ids + (head)))    // device id of reader head on bus
+
+#if w_heads >= w_head_ids || broadcast_id % w_head_ids < w_heads
+#error "every reader head needs own device id: w_heads < w_head_ids, broadcast_id is not head id"
+#endif
 #define         w_delay     1000                // read card delay
 
-WIEGAND         wiegand;                        // object for reading data from Wiegnad RFID
+// reader heads (one column per head): data pins D0 and D1 (on the same port), built-in led and zummer pins
+const uint8_t   w_d0_pins[w_heads]  = { 2,  A0 };
+const uint8_t   w_d1_pins[w_heads]  = { 3,  A1 };
+WiegandSignal   w_signals[w_heads]  = { WiegandSignal(7, 6), WiegandSignal(10, 9) };
+
+WiegandReader   w_readers[w_heads];             // objects for reading data from Wiegnad RFID heads
 unsigned long   w_last_card;                    // last read card id
-WiegandSignal   w_signal(w_led_pin, w_zum_pin); // object for signaling with led and zummer
-Timer           w_timer;                        // read card timer
+Timer           w_timers[w_heads];              // read card timers
 
 #pragma endregion //V_WIEGAND
 
@@ -101,6 +130,181 @@ bool            reed_flag = true;               //
 
 #pragma endregion //V_REED SWITCH
 
+#pragma region V_INPUTS
+
+#if INPUTS
+
+#define         in_exit_pin     A2              // exit button (closes to ground)
+#define         in_tamper_pin   A3              // tamper contact (closed to ground while case is shut)
+#define         in_reed_debounce    20          // ms of stable level taken as edge
+#define         in_exit_debounce    30
+#define         in_tamper_debounce  50
+
+#define         dr_grant        5000            // door opened this long after access allowed (or exit) is not forced
+#define         dr_reports      4               // max door events waiting for acknowledgement of master
+#define         dr_retry        500             // repeat of unacknowledged door event
+#define         dr_tries        5               // door event is given up after this many frames
+
+#define         dr_alarm_door   1               // door forced or held open (bit of dr_alarm)
+#define         dr_alarm_tamper 2               // case of reader opened
+
+InputManager    inputs;                         // debounced contacts, events with time of edge
+uint8_t         in_reed;                        // indexes of inputs
+uint8_t         in_exit;
+uint8_t         in_tamper;
+
+bool            dr_granted = false;             // access allowed, door is not opened yet
+uint32_t        dr_granted_at = 0;              // time of last grant
+uint8_t         dr_alarm = 0;                   // dr_alarm_* bits, signal is on while any is set
+Timer           dr_held_timer;                  // door opened with grant is open too long
+Message         dr_queue[dr_reports];           // door events for master journal (card - time of edge, other - event)
+uint8_t         dr_queued = 0;                  // amount of waiting events
+uint8_t         dr_sent = 0;                    // frames of the oldest event
+Timer           dr_timer;                       // next frame of the oldest event
+
+#endif //INPUTS
+
+#pragma endregion //V_INPUTS
+
+#pragma region V_JOIN
+
+#if JOIN
+
+#define         jn_slot_time    50              // ms of one join slot (frame and acknowledgement at 9600 baud)
+#define         jn_slots        16              // start backoff is 'device_id % jn_slots' slots
+#define         jn_unknown      16              // first slot of readers without slot from master after resync
+#define         jn_jitter       20              // max random addition to every wait
+#define         jn_quiet        10              // bus has to be quiet this long before join frame (listen before talk)
+#define         jn_retries      5               // unanswered join frames (with doubled backoff) before giving up
+
+Timer           jn_timer;                       // next join frame timer
+uint8_t         jn_pending = 0;                 // reader heads not acknowledged yet (bit per head)
+uint8_t         jn_last_head = 0xFF;            // head of last join frame (0xFF - none)
+uint8_t         jn_tries = 0;                   // unanswered join frames in a row
+int16_t         jn_slot = -1;                   // slot given by master (-1 - not given)
+uint32_t        jn_last_rx = 0;                 // time bus was seen busy last
+
+#endif //JOIN
+
+#pragma endregion //V_JOIN
+
+#pragma region V_LIVENESS
+
+#define         hb_idle         5000            // heartbeat after this long without own frames (every frame is heartbeat)
+#define         hb_retry        1000            // first heartbeat retry while master is silent (doubled for every next one)
+#define         hb_retry_max    8000            // max heartbeat retry period
+
+#if LIVENESS
+Timer           hb_timer;                       // next heartbeat timer
+uint16_t        hb_backoff = hb_retry;          // period before the next unacknowledged heartbeat
+#endif //LIVENESS
+
+#pragma endregion //V_LIVENESS
+
+#pragma region V_PRIORITY
+
+#define         pb_ack_slot     20              // ms of acknowledgement slot (the same as on master)
+#define         pb_ack_slots    16              // slots in repeat period of master
+
+#if PRIORITY
+uint16_t        pb_sequence = 0;                // sequence of last applied command
+uint8_t         pb_mode = 0;                    // pc_normal, pc_unlock_all or pc_lockdown
+Timer           pb_ack_timer;                   // acknowledgement in own slot
+#endif //PRIORITY
+
+#pragma endregion //V_PRIORITY
+
+#pragma region V_FILTER
+
+#if BLOCK_FILTER
+
+#define         fl_address      16              // EEPROM address of filter (after device id)
+#define         fl_reports      4               // max rejected cards waiting for report to master
+#define         fl_report_time  1000            // pause between reports
+
+CardFilter      filter;                         // blocked cards (updated by master)
+Message         fl_queue[fl_reports];           // rejected cards for master journal
+uint8_t         fl_queued = 0;                  // amount of waiting reports
+Timer           fl_timer;                       // reports sending timer
+
+#endif //BLOCK_FILTER
+
+#pragma endregion //V_FILTER
+
+#pragma region V_PROFILER
+
+#if PROFILE
+
+#define         prof_period     10000           // statistics printing period
+#define         prof_tolerance  10              // allowed slowdown relative to baseline (%)
+
+// measured code paths
+enum ProfileSlot
+{
+    p_wiegand_decode,
+    p_wiegand_to_decimal,
+    p_et_send,
+    p_et_receive,
+    p_handle_response,
+    p_count
+};
+
+const char      p_name_0[] PROGMEM = "WiegandReader decode";
+const char      p_name_1[] PROGMEM = "wiegandToDecimal";
+const char      p_name_2[] PROGMEM = "Channel::send";
+const char      p_name_3[] PROGMEM = "Channel::receive";
+const char      p_name_4[] PROGMEM = "handleResponse";
+const char* const prof_names[p_count] PROGMEM = { p_name_0, p_name_1, p_name_2, p_name_3, p_name_4 };
+
+// mean cycles of reference build (0 - not measured yet). after intended performance changes run image under simavr:
+// host/build/sim_bench firmware.elf --update main.cpp
+const uint32_t  prof_baselines[p_count] PROGMEM = { 0, 0, 0, 0, 0 };
+
+Profiler        profiler;                       // cycle counter of hot paths
+Timer           prof_timer;                     // statistics printing timer
+
+#define profile_start(slot) profiler.start(slot)
+#define profile_stop(slot)  profiler.stop(slot)
+
+#else
+
+#define profile_start(slot)
+#define profile_stop(slot)
+
+#endif //PROFILE
+
+#if PROFILE || BENCHMARK
+
+// Timer1 overflows of cycle counter (without profiler Timer1 and its vector stay free for other code)
+ISR(TIMER1_OVF_vect)
+{
+    Profiler::overflow();
+}
+
+#endif //PROFILE || BENCHMARK
+
+#pragma endregion //V_PROFILER
+
+#pragma region V_TRACE
+
+#if TRACE_RECORD || TRACE_REPLAY
+
+#define         trace_speed     1               // replay speed multiplier (1 - original timing)
+TraceStream     trace;                          // recorder/player of bus traffic between Channel and RS485
+#define         bus_stream      trace
+
+#else
+
+#define         bus_stream      rs485
+
+#endif //TRACE_RECORD || TRACE_REPLAY
+
+#if TRACE_IDS
+Tracer          tracer;                         // stages of card transactions
+#endif //TRACE_IDS
+
+#pragma endregion //V_TRACE
+
 #pragma region SERVER_STATES
                                                 
 // responses:
@@ -110,6 +314,7 @@ bool            reed_flag = true;               //
 #define st_denied           3                   // access denied
 #define st_invalid          4                   // invalid card (database does not contain such card)
 #define st_blocked          5                   // card is blocked
+#define st_busy             6                   // master is overloaded, retry after other_id ms
 
 // errors:
 #define er_no_srvr_cnctn    95                  // no server connection             | !client.connect(server, port)
@@ -119,6 +324,35 @@ bool            reed_flag = true;               //
 #define er_timeout          99                  // server connection timeout        | !client.available()
 #define er_no_ethr_cnctn    100                 // no ethernet connection           | !ethernetConnected()
 
+// control (not responses, no signals):
+#define ct_filter_add       110                 // add card to blocked cards filter
+#define ct_filter_remove    111                 // remove card from blocked cards filter
+#define ct_filter_clear     112                 // clear blocked cards filter
+#define ct_filter_hit       113                 // card rejected by filter (reader report for journal)
+#define ct_register         114                 // reader started
+#define ct_ack              115                 // master got control frame (other - its state). to master: priority
+                                                // command applied (card - sequence, other - heads of reader)
+#define ct_heartbeat        116                 // reader is alive (other - heads of reader)
+#define ct_status           117                 // reader status (other - status)
+#define ct_resync           118                 // every reader joins again in slot order (other - slot time, ms)
+#define ct_priority         119                 // site-wide command, goes before other frames (card - sequence, other - command)
+#define ct_door             120                 // door event for journal (card - reader millis() of edge, other - event)
+
+// priority commands (other of ct_priority):
+#define pc_normal           0                   // end of unlock or lockdown
+#define pc_unlock_all       1                   // emergency: wicket is open until pc_normal
+#define pc_lockdown         2                   // nobody passes until pc_normal, cards are not looked up
+#define pc_cache_flush      3                   // forget filter and lookup retry
+
+// door events (other of ct_door):
+#define dr_closed           0                   // door closed
+#define dr_opened           1                   // door opened after access allowed or exit button
+#define dr_forced           2                   // door opened without access
+#define dr_held             3                   // door opened with access is still open after reed_time
+#define dr_exit             4                   // exit button pressed (door is unlocked locally)
+#define dr_tamper           5                   // case of reader opened
+#define dr_tamper_closed    6                   // case of reader closed again
+
 #pragma endregion //SERVER_STATES
 
 #pragma region F_DECLARATION
@@ -138,11 +372,95 @@ void sendData(unsigned short device_id, unsigned long card_id, unsigned short st
 // reverses code by bit
 unsigned long wiegandToDecimal(unsigned long code);
 
-// handle response from server
-void handleResponse();
+// handle response from server (frame stays in receive buffer of channel)
+void handleResponse(const Message& message);
+
+// handle card read by reader head
+void readCard(uint8_t head, unsigned long code);
+
+// start signaling of reader head (all heads if head < 0)
+void invokeSignal(int8_t head, WiegandSignal::Length length, uint8_t count);
+
+// apply filter update from master
+void handleFilter(const Message& message);
+
+// send oldest card rejected by filter to master (no response is expected)
+void reportFiltered();
+
+// start joining of all heads after 'position' join slots
+void startJoin(uint16_t position, uint16_t slot_time);
+
+// send join frame of next head not acknowledged yet (or back off)
+void sendJoin();
+
+// apply priority command of master (once per sequence) and schedule acknowledgement
+void handlePriority(const Message& message);
+
+// acknowledge last priority command for all heads (no response is expected)
+void sendPriorityAck();
+
+// apply debounced edge of input (door state, exit button, tamper)
+void handleInput(const InputManager::Event& event);
+
+// queue door event for master journal
+void queueDoorEvent(uint8_t event, uint32_t time);
+
+// send the oldest door event (again until master acknowledges it)
+void sendDoorEvent();
+
+// remove the oldest door event (acknowledged or given up)
+void popDoorEvent();
 
 #pragma endregion //F_DECLARATION
 
+#pragma region INTERRUPTS
+
+// pin change interrupts of all ports are shared by wiegand heads and RS485 receiver
+
+ISR(PCINT0_vect)
+{
+    uint8_t pins = PINB;
+    WiegandReader::pinChange(&PINB, pins);
+    #if INPUTS
+    InputManager::pinChange(&PINB, pins);
+    #endif //INPUTS
+}
+
+ISR(PCINT1_vect)
+{
+    uint8_t pins = PINC;
+    WiegandReader::pinChange(&PINC, pins);
+    #if INPUTS
+    InputManager::pinChange(&PINC, pins);
+    #endif //INPUTS
+}
+
+ISR(PCINT2_vect)
+{
+    uint8_t pins = PIND;
+
+    // receiver measures bit timing from the moment of call, so it goes first and only on it's own pin change
+    if ((pins & _BV(rs_rx_pin)) != rs_rx_state)
+    {
+        rs_rx_state = pins & _BV(rs_rx_pin);
+        NeoSWSerial::rxISR(pins);
+    }
+    WiegandReader::pinChange(&PIND, pins);
+    #if INPUTS
+    InputManager::pinChange(&PIND, pins);
+    #endif //INPUTS
+}
+
+// debounce of inputs, runs only while some of them settles
+#if INPUTS
+ISR(TIMER0_COMPB_vect)
+{
+    InputManager::tick();
+}
+#endif //INPUTS
+
+#pragma endregion //INTERRUPTS
+
 void setup()
 {
     #if SET_DEV_ID
@@ -154,18 +472,31 @@ void setup()
     pinMode2(wicket_pin, OUTPUT);
     #endif //WICKET
 
-    #if REED_SWITCH
+    #if INPUTS
+    inputs.begin();
+    in_reed = inputs.add(reed_pin, false, in_reed_debounce);
+    in_exit = inputs.add(in_exit_pin, true, in_exit_debounce);
+    in_tamper = inputs.add(in_tamper_pin, false, in_tamper_debounce);
+    #elif REED_SWITCH
     pinMode2(reed_pin, INPUT_PULLUP);
-    #endif //REED_SWITCH
+    #endif //INPUTS
 
     //device_id = loadDeviceId(0);  // defined in global settings
 
-    wiegand.begin(w_rx_pin, w_tx_pin);
-    pinMode2(w_zum_pin, OUTPUT);
-    pinMode2(w_led_pin, OUTPUT);
+    for (uint8_t h = 0; h < w_heads; h++)
+    {
+        w_readers[h].begin(w_d0_pins[h], w_d1_pins[h]);
+        w_timers[h].begin(w_delay);
+    }
+
+    #if BLOCK_FILTER
+    filter.begin(fl_address);
+    fl_timer.begin(fl_report_time);
+    #endif //BLOCK_FILTER
 
+    rs_rx_state = PIND & _BV(rs_rx_pin);
     rs485.begin(rs_baud);
-    easy_transfer.begin(details(message), &rs485);
+    channel.begin(&bus_stream);
     
 
     #if DEBUG
@@ -179,14 +510,52 @@ void setup()
     debugln_s("\t\t---");
     #endif //DEBUG
 
-    // registering new connected device
-    sendData(
-        device_id,
-        0,
-        0,
-        0
-    );
-    w_timer.begin(w_delay);
+    #if (PROFILE || BENCHMARK || TRACE_RECORD || TRACE_REPLAY || TRACE_IDS) && !DEBUG
+    Serial.begin(serial_baud);
+    #endif //(PROFILE || BENCHMARK || TRACE_RECORD || TRACE_REPLAY || TRACE_IDS) && !DEBUG
+
+    #if TRACE_IDS
+    tracer.begin(&Serial, 0);
+    #endif //TRACE_IDS
+
+    #if TRACE_RECORD
+    trace.record(&rs485, &Serial);
+    #elif TRACE_REPLAY
+    trace.replay(&Serial, &Serial, trace_speed);
+    #endif //TRACE_RECORD
+
+    #if BENCHMARK
+    {
+        Benchmark benchmark{};
+        benchmark.run(Serial, wiegandToDecimal);
+    }
+    #endif //BENCHMARK
+
+    #if PROFILE
+    profiler.begin();
+    prof_timer.begin(prof_period);
+    #endif //PROFILE
+
+    // registering new connected devices (every reader head). master without registry takes it as lookup of card 0.
+    // all readers start at once after power cut: every one waits for its own slot
+    #if JOIN
+    randomSeed(device_id);
+    startJoin(device_id % jn_slots, jn_slot_time);
+    #else
+    for (uint8_t h = 0; h < w_heads; h++)
+    {
+        sendData(
+            head_id(h),
+            0,
+            ct_register,
+            0
+        );
+    }
+    #endif //JOIN
+
+    #if LIVENESS
+    hb_timer.begin(hb_idle);
+    #endif //LIVENESS
 }
 
 void loop()
@@ -195,13 +564,36 @@ void loop()
     #if WICKET
     if (wicket_timer.update())
     {
+
         digitalWrite2(wicket_pin, HIGH);
         wicket_timer.stop();
         debugln_s("wicket closed");
     }
     #endif //WICKET
 
-    #if REED_SWITCH
+    // door events come from interrupts with time of edge, loop only takes them
+    #if INPUTS
+    InputManager::Event event;
+    while (inputs.pop(event))
+    {
+        handleInput(event);
+    }
+    if (dr_held_timer.update())
+    {
+        dr_held_timer.stop();
+        if (inputs.active(in_reed))
+        {
+            debugln_s("door held open");
+            dr_alarm |= dr_alarm_door;
+            reed_flag = false;
+            queueDoorEvent(dr_held, millis());
+        }
+    }
+    if (dr_queued > 0 && dr_timer.update())
+    {
+        sendDoorEvent();
+    }
+    #elif REED_SWITCH
     if (reed_timer.update())
     {
         if (digitalRead2(reed_pin) == HIGH)
@@ -215,7 +607,7 @@ void loop()
         reed_flag = true;
         reed_timer.stop();
     }
-    #endif //REED_SWITCH
+    #endif //INPUTS
 
     // too much time passed since last send (no response from master)
     if (rs_wait_timer.update())
@@ -223,51 +615,128 @@ void loop()
         rs_flag = false;
     }
 
-    // received message from master
-    if (easy_transfer.receiveData())
+    // nothing was sent for long (or master is silent): heartbeat, unanswered one means "no master" at once
+    #if LIVENESS
+    if (hb_timer.update())
     {
-        handleResponse();
+        sendData(
+            head_id(0),
+            0,
+            ct_heartbeat,
+            w_heads
+        );
+        hb_timer.begin(hb_backoff);
+        hb_backoff = hb_backoff < hb_retry_max / 2 ? hb_backoff * 2 : hb_retry_max;
     }
+    #endif //LIVENESS
 
-    // making signal if something is wrong
-    if (!reed_flag)
+    // master was busy: the same lookup again after its hint
+    if (rs_retry_timer.update())
     {
-        w_signal.update(WiegandSignal::Length::s_short_short, false, true);
+        rs_retry_timer.stop();
+        debugln_s("lookup retry");
+        uint16_t trace = 0;
+        #if TRACE_IDS
+        trace = tracer.find(rs_retry_device);
+        tracer.stage(rs_retry_device, F("retry"));
+        #endif //TRACE_IDS
+        sendData(
+            rs_retry_device,
+            rs_retry_card,
+            0,
+            trace
+        );
     }
-    else if (!rs_flag)
+
+    #if PRIORITY
+    if (pb_ack_timer.update())
     {
-        w_signal.update(WiegandSignal::Length::s_short, false, true);
+        sendPriorityAck();
     }
-    else if (!ethernet_flag)
+    #endif //PRIORITY
+
+    #if JOIN
+    if (bus_stream.available())
     {
-        w_signal.update(WiegandSignal::Length::s_medium, false, true);
+        jn_last_rx = millis();
     }
-    else
+    if (jn_pending && jn_timer.update())
     {
-        w_signal.update();
+        sendJoin();
     }
+    #endif //JOIN
 
-    // read a card
-    if (wiegand.available())
+    // received message from master
+    profile_start(p_et_receive);
+    const Message* received = channel.receive();
+    profile_stop(p_et_receive);
+    if (received)
     {
-        w_last_card = wiegandToDecimal(wiegand.getCode());
-        
-        if (w_timer.update())
+        profile_start(p_handle_response);
+        handleResponse(*received);
+        profile_stop(p_handle_response);
+    }
+
+    // making signal if something is wrong
+    for (uint8_t h = 0; h < w_heads; h++)
+    {
+        if (!reed_flag)
         {
-            // check for ethernet connection, signaling state
-            if (ethernet_flag && !w_signal.is_invoke)
-            {
-                debug_s("read card: ");
-                debugln(w_last_card);
-                sendData(
-                    device_id, 
-                    w_last_card, 
-                    0, 
-                    0
-                );
-            }
+            w_signals[h].update(WiegandSignal::Length::s_short_short, false, true);
+        }
+        else if (!rs_flag)
+        {
+            w_signals[h].update(WiegandSignal::Length::s_short, false, true);
         }
+        else if (!ethernet_flag)
+        {
+            w_signals[h].update(WiegandSignal::Length::s_medium, false, true);
+        }
+        else
+        {
+            w_signals[h].update();
+        }
+    }
+
+    // read cards
+    for (uint8_t h = 0; h < w_heads; h++)
+    {
+        // only calls which convert complete frame are counted (idle polling would hide decode cost)
+        profile_start(p_wiegand_decode);
+        if (!w_readers[h].available())
+            continue;
+        profile_stop(p_wiegand_decode);
+
+        #if TRACE_RECORD
+        trace.frame(w_readers[h].getWiegandType(), w_readers[h].getCode(), h);
+        #endif //TRACE_RECORD
+
+        readCard(h, w_readers[h].getCode());
+    }
+
+    #if BLOCK_FILTER
+    if (fl_queued > 0 && fl_timer.update())
+    {
+        reportFiltered();
+    }
+    #endif //BLOCK_FILTER
+
+    #if TRACE_REPLAY
+    unsigned long w_code;
+    uint8_t w_head;
+    if (trace.frame(w_code, w_head) && w_head < w_heads)
+    {
+        readCard(w_head, w_code);
+    }
+    #endif //TRACE_REPLAY
+
+    #if PROFILE
+    if (prof_timer.update())
+    {
+        profiler.report(Serial, prof_names, prof_baselines, p_count, prof_tolerance);
+        profiler.reset();
     }
+    #endif //PROFILE
 }
 
 #pragma region F_DESCRIPTION
@@ -283,8 +752,10 @@ void clearMemory()
 
 void saveDeviceId(int address, unsigned long id)
 {
+    // 4 bytes in EEPROM whatever size of unsigned long is (host build of tools has 8 bytes long)
+    uint32_t value = id;
     byte buf[4];
-    (unsigned long&)buf = id;
+    memcpy(buf, &value, sizeof(buf));
     for(byte i = 0; i < 4; i++) 
     {
         EEPROM.write(address + i, buf[i]);
@@ -300,7 +771,8 @@ unsigned long loadDeviceId(int address)
     { 
         buf[i] = EEPROM.read(address + i);
     }
-    unsigned long &id = (unsigned long&)buf;
+    uint32_t id;
+    memcpy(&id, buf, sizeof(id));
     return id;
 }
 
@@ -308,14 +780,19 @@ void sendData(unsigned short device_id, unsigned long card_id, unsigned short st
 {
     rs_wait_timer.begin(rs_rspns);
 
+    #if LIVENESS
+    hb_timer.begin(hb_idle);
+    #endif //LIVENESS
+
+    Message message;
     message.set(device_id, card_id, state_id, other_id);
 
     debugln_f("\nET >> \t[ %u; %lu; %u; %u ]", 
         message.device_id, message.card_id, message.state_id, message.other_id);
 
-    easy_transfer.sendData();
-
-    message.clean();
+    profile_start(p_et_send);
+    channel.send(message);
+    profile_stop(p_et_send);
 }
 
 unsigned long wiegandToDecimal(unsigned long code)
@@ -334,34 +811,515 @@ unsigned long wiegandToDecimal(unsigned long code)
     return code_decimal;
 }
 
-void handleResponse()
+void readCard(uint8_t head, unsigned long code)
+{
+    profile_start(p_wiegand_to_decimal);
+    w_last_card = wiegandToDecimal(code);
+    profile_stop(p_wiegand_to_decimal);
+
+    if (w_timers[head].update())
+    {
+        // blocked card is rejected without master, which gets report later
+        #if BLOCK_FILTER
+        if (filter.contains(w_last_card))
+        {
+            debug_s("card rejected by filter: ");
+            debugln(w_last_card);
+            invokeSignal(head, WiegandSignal::Length::s_short, 10);
+
+            // the oldest report is lost when queue is full
+            if (fl_queued == fl_reports)
+            {
+                fl_queued--;
+                memmove(&fl_queue[0], &fl_queue[1], sizeof(Message) * fl_queued);
+            }
+            fl_queue[fl_queued++].set(head_id(head), w_last_card, ct_filter_hit, 0);
+            return;
+        }
+        #endif //BLOCK_FILTER
+
+        // nobody passes during lockdown, master is not asked
+        #if PRIORITY
+        if (pb_mode == pc_lockdown)
+        {
+            debugln_s("lockdown: card denied");
+            invokeSignal(head, WiegandSignal::Length::s_medium, 10);
+            return;
+        }
+        #endif //PRIORITY
+
+        // check for ethernet connection, signaling state
+        if (ethernet_flag && !w_signals[head].is_invoke)
+        {
+            debug_s("read card: ");
+            debugln(w_last_card);
+            rs_retry_timer.stop();
+            rs_retry_count = 0;
+
+            // trace id goes to master in other_id
+            uint16_t trace = 0;
+            #if TRACE_IDS
+            trace = tracer.open(head_id(head));
+            tracer.stage(head_id(head), F("tx"));
+            #endif //TRACE_IDS
+            sendData(
+                head_id(head), 
+                w_last_card, 
+                0, 
+                trace
+            );
+        }
+    }
+}
+
+void invokeSignal(int8_t head, WiegandSignal::Length length, uint8_t count)
+{
+    for (uint8_t h = 0; h < w_heads; h++)
+    {
+        if (head < 0 || head == h)
+            w_signals[h].invoke(length, count);
+    }
+}
+
+void handleFilter(const Message& message)
+{
+    #if BLOCK_FILTER
+    switch (message.state_id)
+    {
+    case ct_filter_add:
+        if (!filter.add(message.card_id))
+        {
+            debugln_s("filter is full, card lost");
+        }
+        break;
+    case ct_filter_remove:
+        filter.remove(message.card_id);
+        break;
+    case ct_filter_clear:
+        filter.clear();
+        break;
+    }
+    debugln_f("filter updated: %u %lu", message.state_id, message.card_id);
+    #endif //BLOCK_FILTER
+}
+
+void reportFiltered()
+{
+    #if BLOCK_FILTER
+    const Message& message = fl_queue[0];
+
+    debugln_f("\nET >> \t[ %u; %lu; %u; %u ]",
+        message.device_id, message.card_id, message.state_id, message.other_id);
+
+    channel.send(message);
+    fl_queued--;
+    memmove(&fl_queue[0], &fl_queue[1], sizeof(Message) * fl_queued);
+    #endif //BLOCK_FILTER
+}
+
+void startJoin(uint16_t position, uint16_t slot_time)
+{
+    #if JOIN
+    jn_pending = (1 << w_heads) - 1;
+    jn_last_head = 0xFF;
+    jn_tries = 0;
+    jn_timer.begin((uint32_t)position * slot_time + random(jn_jitter));
+    debugln_f("join after %u slots", position);
+    #endif //JOIN
+}
+
+void sendJoin()
+{
+    #if JOIN
+    // listen before talk: somebody is on the bus, try a little later
+    if (millis() - jn_last_rx < jn_quiet)
+    {
+        jn_timer.begin(jn_quiet + random(jn_jitter));
+        return;
+    }
+
+    uint8_t head = 0;
+    while (!(jn_pending & (1 << head)))
+        head++;
+
+    // no acknowledgement during slot: bus is crowded, waiting twice longer every time
+    if (head == jn_last_head)
+    {
+        jn_last_head = 0xFF;
+        if (++jn_tries > jn_retries)
+        {
+            debugln_s("join failed");
+            jn_pending = 0;
+            rs_flag = false;
+            return;
+        }
+        jn_timer.begin(((uint32_t)jn_slot_time << jn_tries) + random(jn_jitter));
+        return;
+    }
+
+    jn_last_head = head;
+    Message message;
+    message.set(head_id(head), 0, ct_register, 0);
+
+    debugln_f("\nET >> \t[ %u; %lu; %u; %u ]",
+        message.device_id, message.card_id, message.state_id, message.other_id);
+
+    channel.send(message);
+    jn_timer.begin(jn_slot_time);
+    #endif //JOIN
+}
+
+void handlePriority(const Message& message)
+{
+    #if PRIORITY
+    uint16_t sequence = message.card_id;
+    uint8_t command = message.other_id;
+
+    // repeated frame: command is applied already, only acknowledgement was lost
+    if (sequence != pb_sequence)
+    {
+        pb_sequence = sequence;
+        switch (command)
+        {
+        case pc_normal:
+            debugln_s("priority: normal");
+            invokeSignal(-1, WiegandSignal::Length::s_medium, 1);
+            #if WICKET
+            digitalWrite2(wicket_pin, HIGH);
+            #endif //WICKET
+            pb_mode = command;
+            break;
+
+        case pc_unlock_all:
+            debugln_s("priority: unlock all");
+            invokeSignal(-1, WiegandSignal::Length::s_long, 1);
+            #if WICKET
+            wicket_timer.stop();
+            digitalWrite2(wicket_pin, LOW);
+            #endif //WICKET
+            #if INPUTS
+            dr_held_timer.stop();
+            #elif REED_SWITCH
+            reed_timer.stop();
+            #endif //INPUTS
+            pb_mode = command;
+            break;
+
+        case pc_lockdown:
+            debugln_s("priority: lockdown");
+            invokeSignal(-1, WiegandSignal::Length::s_short, 10);
+            #if WICKET
+            wicket_timer.stop();
+            digitalWrite2(wicket_pin, HIGH);
+            #endif //WICKET
+            rs_retry_timer.stop();
+            pb_mode = command;
+            break;
+
+        case pc_cache_flush:
+            debugln_s("priority: cache flush");
+            invokeSignal(-1, WiegandSignal::Length::s_short_short, 1);
+            #if BLOCK_FILTER
+            filter.clear();
+            #endif //BLOCK_FILTER
+            rs_retry_timer.stop();
+            break;
+
+        default:
+            debugln_f("priority: unknown command %u", command);
+            break;
+        }
+    }
+
+    // readers acknowledge one by one: in join slot given by master, in random one without it
+    #if JOIN
+    uint16_t slot = jn_slot >= 0 ? jn_slot : random(pb_ack_slots);
+    #else
+    uint16_t slot = random(pb_ack_slots);
+    #endif //JOIN
+    pb_ack_timer.begin((uint32_t)slot * pb_ack_slot);
+    #endif //PRIORITY
+}
+
+void sendPriorityAck()
+{
+    #if PRIORITY
+    pb_ack_timer.stop();
+    Message message;
+    message.set(head_id(0), pb_sequence, ct_ack, w_heads);
+
+    debugln_f("\nET >> \t[ %u; %lu; %u; %u ]",
+        message.device_id, message.card_id, message.state_id, message.other_id);
+
+    channel.send(message);
+    #endif //PRIORITY
+}
+
+void handleInput(const InputManager::Event& event)
+{
+    #if INPUTS
+    if (event.input == in_reed)
+    {
+        if (!event.active)
+        {
+            debugln_s("door closed");
+            dr_held_timer.stop();
+            dr_alarm &= ~dr_alarm_door;
+            reed_flag = dr_alarm == 0;
+            queueDoorEvent(dr_closed, event.time);
+            return;
+        }
+
+        // grant is compared with time of edge, not with time of handling: door opened before grant is forced
+        int32_t since_grant = (int32_t)(event.time - dr_granted_at);
+        bool granted = dr_granted && since_grant >= 0 && since_grant <= dr_grant;
+        dr_granted = false;
+
+        // everything is unlocked: door may stay open
+        #if PRIORITY
+        if (pb_mode == pc_unlock_all)
+        {
+            queueDoorEvent(dr_opened, event.time);
+            return;
+        }
+        #endif //PRIORITY
+
+        if (granted)
+        {
+            debugln_s("door opened");
+            dr_held_timer.begin(reed_time);
+            queueDoorEvent(dr_opened, event.time);
+        }
+        else
+        {
+            debugln_s("door forced");
+            dr_alarm |= dr_alarm_door;
+            reed_flag = false;
+            queueDoorEvent(dr_forced, event.time);
+        }
+        return;
+    }
+
+    // way out needs no master and works during lockdown too
+    if (event.input == in_exit && event.active)
+    {
+        debugln_s("exit button");
+        #if WICKET
+        bool unlocked = false;
+        #if PRIORITY
+        unlocked = pb_mode == pc_unlock_all;
+        #endif //PRIORITY
+        if (!unlocked)
+        {
+            wicket_timer.begin(wicket_time);
+            digitalWrite2(wicket_pin, LOW);
+        }
+        #endif //WICKET
+        dr_granted = true;
+        dr_granted_at = event.time;
+        queueDoorEvent(dr_exit, event.time);
+        return;
+    }
+
+    if (event.input == in_tamper)
+    {
+        if (event.active)
+        {
+            debugln_s("tamper");
+            dr_alarm |= dr_alarm_tamper;
+            queueDoorEvent(dr_tamper, event.time);
+        }
+        else
+        {
+            debugln_s("tamper closed");
+            dr_alarm &= ~dr_alarm_tamper;
+            queueDoorEvent(dr_tamper_closed, event.time);
+        }
+        reed_flag = dr_alarm == 0;
+    }
+    #endif //INPUTS
+}
+
+void queueDoorEvent(uint8_t event, uint32_t time)
+{
+    #if INPUTS
+    // the oldest event is lost when queue is full
+    if (dr_queued == dr_reports)
+    {
+        popDoorEvent();
+    }
+    dr_queue[dr_queued++].set(head_id(0), time, ct_door, event);
+    if (dr_queued == 1)
+    {
+        dr_timer.begin(0);
+    }
+    #endif //INPUTS
+}
+
+void sendDoorEvent()
+{
+    #if INPUTS
+    // master does not journal door events (or is gone): the oldest one is given up
+    if (dr_sent == dr_tries)
+    {
+        debugln_f("door event %u not acknowledged", dr_queue[0].other_id);
+        popDoorEvent();
+        return;
+    }
+
+    dr_sent++;
+    dr_timer.begin(dr_retry);
+    const Message& event = dr_queue[0];
+    sendData(
+        event.device_id,
+        event.card_id,
+        event.state_id,
+        event.other_id
+    );
+    #endif //INPUTS
+}
+
+void popDoorEvent()
+{
+    #if INPUTS
+    dr_queued--;
+    memmove(&dr_queue[0], &dr_queue[1], sizeof(Message) * dr_queued);
+    dr_sent = 0;
+    if (dr_queued > 0)
+        dr_timer.begin(0);
+    else
+        dr_timer.stop();
+    #endif //INPUTS
+}
+
+void handleResponse(const Message& message)
 {
     debugln_f("\nET << \t[ %u; %lu; %u; %u ]", 
             message.device_id, message.card_id, message.state_id, message.other_id);
 
+    // site-wide command goes before everything, its signal replaces pending ones
+    #if PRIORITY
+    if (message.device_id == broadcast_id && message.state_id == ct_priority)
+    {
+        handlePriority(message);
+        return;
+    }
+    #endif //PRIORITY
+
+    // reader head which message is for (-1 - broadcast)
+    int8_t head = -1;
+    if (message.device_id >= head_id(0) && message.device_id < head_id(w_heads))
+    {
+        head = message.device_id - head_id(0);
+    }
+
     // base data checking (if message was for this device)
-    if (message.device_id != broadcast_id && message.device_id != device_id)
+    if (message.device_id != broadcast_id && head < 0)
     {
         debugln("message not handled");
         return;
     }
+
+    // control messages are not responses to card
+    if (message.state_id >= ct_filter_add && message.state_id <= ct_filter_clear)
+    {
+        handleFilter(message);
+        return;
+    }
+
+    // master got registration, heartbeat or status: it is alive, nothing to signal
+    if (message.state_id == ct_ack)
+    {
+        rs_flag = true;
+        rs_wait_timer.stop();
+        debugln_f("ack of %u", message.other_id);
+
+        // heartbeat got through: the next one after idle period again
+        #if LIVENESS
+        if (message.other_id == ct_heartbeat)
+        {
+            hb_timer.begin(hb_idle);
+            hb_backoff = hb_retry;
+        }
+        #endif //LIVENESS
+
+        // door event is in journal: the next one can go
+        #if INPUTS
+        if (message.other_id == ct_door && dr_queued > 0 && message.card_id == dr_queue[0].card_id)
+        {
+            popDoorEvent();
+        }
+        #endif //INPUTS
+
+        // registration acknowledgement has slot of head in card id
+        #if JOIN
+        if (message.other_id == ct_register && head >= 0)
+        {
+            jn_pending &= ~(1 << head);
+            jn_tries = 0;
+            if (jn_slot < 0 || (int16_t)message.card_id < jn_slot)
+            {
+                jn_slot = message.card_id;
+            }
+        }
+        #endif //JOIN
+
+        return;
+    }
+
+    // master enumerates bus again: known readers in slot order, then the others by device id.
+    // reader without JOIN ignores it
+    if (message.state_id == ct_resync)
+    {
+        #if JOIN
+        startJoin(jn_slot >= 0 ? jn_slot : jn_unknown + device_id % jn_slots, message.other_id);
+        #endif //JOIN
+        return;
+    }
+
+    // other control frames (priority commands of reader without PRIORITY and so on) are not answers, nothing to signal
+    if (message.state_id >= ct_filter_add)
+    {
+        debugln_f("control %u not handled", message.state_id);
+        return;
+    }
+
+    // master without registry answers registration as lookup of card 0
+    #if JOIN
+    if (head >= 0 && message.card_id == 0)
+    {
+        jn_pending &= ~(1 << head);
+    }
+    #endif //JOIN
         
     rs_flag = true;
     rs_wait_timer.stop();
 
+    // busy answer is not the end: lookup is retried under the same trace id
+    #if TRACE_IDS
+    if (message.state_id == st_busy)
+    {
+        tracer.stage(message.device_id, F("busy"));
+    }
+    else
+    {
+        tracer.close(message.device_id, F("rx"), message.state_id);
+    }
+    #endif //TRACE_IDS
+
     delay(handle_delay);
 
     // if error - long signal firstly
     if (message.state_id >= 90)
     {
-        w_signal.invoke(WiegandSignal::Length::s_long_long, 1);
+        invokeSignal(head, WiegandSignal::Length::s_long_long, 1);
     }
 
     switch (message.state_id)
     {
     case st_unknown:
     {
-        w_signal.invoke(WiegandSignal::Length::s_long, 3);
+        invokeSignal(head, WiegandSignal::Length::s_long, 3);
         debugln_s("unknown status");
         break;
     }
@@ -369,6 +1327,12 @@ void handleResponse()
     {
         debugln_s("access allowed");
 
+        // wicket is open anyway, door alert is off
+        #if PRIORITY
+        if (pb_mode == pc_unlock_all)
+            break;
+        #endif //PRIORITY
+
         // opening a wicket
         #if WICKET
         debugln_s("wicket opened");
@@ -376,76 +1340,103 @@ void handleResponse()
         digitalWrite2(wicket_pin, LOW);
         #endif //WICKET
 
-        #if REED_SWITCH
+        #if INPUTS
+        dr_granted = true;
+        dr_granted_at = millis();
+        #elif REED_SWITCH
         debugln_s("reed timer started");
         reed_timer.begin(reed_time);
-        #endif //REEDSWITCH
+        #endif //INPUTS
 
         break;
     }
     case st_re_entry:
     {
-        w_signal.invoke(WiegandSignal::Length::s_long, 2);
+        invokeSignal(head, WiegandSignal::Length::s_long, 2);
         debugln_s("re-entry");
         break;
     }
     case st_denied:
     {
-        w_signal.invoke(WiegandSignal::Length::s_medium, 10);
+        invokeSignal(head, WiegandSignal::Length::s_medium, 10);
         debugln_s("access denied");
         break;
     }
     case st_invalid:
     {
-        w_signal.invoke(WiegandSignal::Length::s_medium, 5);
+        invokeSignal(head, WiegandSignal::Length::s_medium, 5);
         debugln_s("invalid card");
         break;
     }
     case st_blocked:
     {
-        w_signal.invoke(WiegandSignal::Length::s_short, 10);
+        invokeSignal(head, WiegandSignal::Length::s_short, 10);
         debugln_s("card blocked");
         break;
     }
+    case st_busy:
+    {
+        invokeSignal(head, WiegandSignal::Length::s_short_short, 2);
+        debugln_f("master busy, retry after %u ms", message.other_id);
+
+        // person keeps waiting at the door, no need to swipe again
+        if (head >= 0 && message.card_id != 0 && rs_retry_count < rs_retries)
+        {
+            rs_retry_count++;
+            rs_retry_device = message.device_id;
+            rs_retry_card = message.card_id;
+            rs_retry_timer.begin(message.other_id);
+        }
+        break;
+    }
     
     // errors:
     case er_no_srvr_cnctn:
     {
-        w_signal.invoke(WiegandSignal::Length::s_long, 3);
+        invokeSignal(head, WiegandSignal::Length::s_long, 3);
         debugln_s("error: no server connection");
         break;
     }
     case er_request:
     {
-        w_signal.invoke(WiegandSignal::Length::s_short, 5);
+        invokeSignal(head, WiegandSignal::Length::s_short, 5);
         debugln_s("error: wrong server request");
         break;
     }
     case er_no_response:
     {
-        w_signal.invoke(WiegandSignal::Length::s_medium , 3);
+        invokeSignal(head, WiegandSignal::Length::s_medium , 3);
         debugln_s("error: no response from server");
         break;
     }
     case er_json:
     {
-        w_signal.invoke(WiegandSignal::Length::s_short, 5);
+        invokeSignal(head, WiegandSignal::Length::s_short, 5);
         debugln_s("error: wrong json deserialization");
         break;
     }
     case er_timeout:
     {
-        w_signal.invoke(WiegandSignal::Length::s_medium, 3);
+        invokeSignal(head, WiegandSignal::Length::s_medium, 3);
         debugln_s("error: server connection timeout");
         break;
     }
     case er_no_ethr_cnctn:
     {
+        // answer of lookup: gateway has no link and card is not in its index
+        if (message.card_id != 0)
+        {
+            invokeSignal(head, WiegandSignal::Length::s_long, 3);
+            debugln_s("error: no ethernet connection");
+            break;
+        }
+
+        // 0 - link lost, 1 - connected, 2 - link lost, gateway answers by card index
         if (message.other_id == 0)
         {
             ethernet_flag = false;
         }
-        else if (message.other_id == 1)
+        else if (message.other_id == 1 || message.other_id == 2)
         {
             ethernet_flag = true;
         }
@@ -461,8 +1452,6 @@ void handleResponse()
         break;
     }
     }
-
-    message.clean();
 }
 
 #pragma endregion //F_DESCRIPTION
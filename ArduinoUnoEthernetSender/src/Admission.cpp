@@ -0,0 +1,76 @@
+#include "Admission.h"
+
+#define adm_probe       2000                    // one lookup is admitted after this time without samples (backend may be back)
+#define adm_retry_min   200                     // min retry hint
+#define adm_retry_max   5000                    // max retry hint
+#define adm_latency_max 30000                   // longer samples are cut
+
+void Admission::begin(uint16_t budget)
+{
+    _budget = budget;
+    _mean = -1;
+    _deviation = 0;
+    _probing = false;
+    _rejected = 0;
+}
+
+void Admission::sample(uint32_t latency)
+{
+    int16_t value = min(latency, (uint32_t)adm_latency_max);
+    _sampled = millis();
+
+    // server is fast again: old slow samples would keep readers busy for many lookups more
+    bool recovered = _probing && (uint32_t)value <= _budget;
+    _probing = false;
+    if (_mean < 0 || recovered)
+    {
+        _mean = value;
+        _deviation = value / 2;
+        return;
+    }
+
+    // the same smoothing as rtt estimation: deviation 1/4, mean 1/8
+    int16_t delta = _mean - value;
+    if (delta < 0)
+        delta = -delta;
+    _deviation += (delta - _deviation) / 4;
+    _mean += (value - _mean) / 8;
+}
+
+uint16_t Admission::admit(uint8_t queued)
+{
+    uint32_t wait = expected(queued);
+    if (wait <= _budget)
+        return 0;
+
+    // nobody waits before it (busy would not make it faster), or nothing finished for long: it is a probe
+    if (queued == 0 || millis() - _sampled >= adm_probe)
+    {
+        _sampled = millis();
+        _probing = true;
+        return 0;
+    }
+
+    _rejected++;
+    return constrain(wait - _budget, (uint32_t)adm_retry_min, (uint32_t)adm_retry_max);
+}
+
+bool Admission::overloaded(uint8_t queued)
+{
+    return queued > 0 && expected(queued - 1) > _budget;
+}
+
+uint32_t Admission::estimate()
+{
+    return _mean < 0 ? 0 : (int32_t)_mean + 2 * (int32_t)_deviation;
+}
+
+uint16_t Admission::rejected()
+{
+    return _rejected;
+}
+
+uint32_t Admission::expected(uint8_t queued)
+{
+    return (uint32_t)(queued + 1) * estimate();
+}
@@ -0,0 +1,43 @@
+#ifndef ADMISSION_H
+#define ADMISSION_H
+
+#include <Arduino.h>
+
+// admission control of server lookups: latency of finished lookups is tracked (smoothed mean + deviation),
+// new lookup is admitted only if it and lookups queued before it fit into time budget of reader.
+// otherwise reader gets "busy" right away with hint when to retry. lookup with nothing queued before it is always
+// admitted; such lookup or periodic probe admitted over budget which comes back in budget restarts the estimate
+class Admission
+{
+public:
+    // budget - time (ms) reader may wait for answer
+    void begin(uint16_t budget);
+
+    // add duration (ms) of finished lookup
+    void sample(uint32_t latency);
+
+    // returns 0 if lookup may start now, otherwise time (ms) after which it should be retried
+    uint16_t admit(uint8_t queued);
+
+    // returns true if queued lookups do not fit into budget already (low-priority work should wait)
+    bool overloaded(uint8_t queued);
+
+    // expected duration of one lookup (mean + 2 deviations)
+    uint32_t estimate();
+
+    // lookups answered with busy
+    uint16_t rejected();
+
+private:
+    // expected time of queued lookups and one more
+    uint32_t expected(uint8_t queued);
+
+    uint16_t        _budget = 0;
+    int16_t         _mean = -1;                 // smoothed latency, ms (-1 - no samples yet)
+    int16_t         _deviation = 0;             // smoothed mean deviation, ms
+    uint32_t        _sampled = 0;               // time of last sample or probe
+    bool            _probing = false;           // lookup admitted over budget is running
+    uint16_t        _rejected = 0;
+};
+
+#endif
@@ -0,0 +1,56 @@
+#include "AllowSet.h"
+
+void AllowSet::add(unsigned short device_id, unsigned long card_id)
+{
+    if (card_id == 0 || find(device_id, card_id) != nullptr)
+        return;
+
+    Pair& p = _pairs[_next];
+    _next = (_next + 1) % ALLOW_SLOTS;
+    p.card_id = card_id;
+    p.device_id = device_id;
+    p.granted = false;
+}
+
+void AllowSet::remove(unsigned short device_id, unsigned long card_id)
+{
+    Pair* p = find(device_id, card_id);
+    if (p != nullptr)
+        p->card_id = 0;
+}
+
+bool AllowSet::grant(unsigned short device_id, unsigned long card_id)
+{
+    Pair* p = find(device_id, card_id);
+    if (p == nullptr)
+        return false;
+
+    p->granted = true;
+    return true;
+}
+
+bool AllowSet::settle(unsigned short device_id, unsigned long card_id, unsigned short state_id, unsigned short allow_id, bool& agreed)
+{
+    agreed = true;
+    Pair* p = find(device_id, card_id);
+    if (p == nullptr || !p->granted)
+        return false;
+
+    p->granted = false;
+    if (state_id != allow_id)
+    {
+        agreed = false;
+        p->card_id = 0;
+    }
+    return true;
+}
+
+AllowSet::Pair* AllowSet::find(unsigned short device_id, unsigned long card_id)
+{
+    for (uint8_t i = 0; i < ALLOW_SLOTS; i++)
+    {
+        if (_pairs[i].card_id == card_id && _pairs[i].device_id == device_id)
+            return &_pairs[i];
+    }
+    return nullptr;
+}
@@ -0,0 +1,41 @@
+#ifndef ALLOW_SET_H
+#define ALLOW_SET_H
+
+#include <Arduino.h>
+
+#define ALLOW_SLOTS     32                      // max remembered allowed card/reader pairs
+
+// cards recently allowed by server on readers. such card is allowed again right away (optimistic grant),
+// server lookup is done after it and settle() tells whether server agreed
+class AllowSet
+{
+public:
+    // remember that server allowed card on reader (the oldest pair is replaced when set is full)
+    void add(unsigned short device_id, unsigned long card_id);
+
+    // forget card on reader
+    void remove(unsigned short device_id, unsigned long card_id);
+
+    // returns true if card on reader may be allowed before server answer (grant waits for settle())
+    bool grant(unsigned short device_id, unsigned long card_id);
+
+    // server answered lookup of card on reader. returns true if reader was already answered by grant()
+    // (agreed is false if server state differs from allow, then pair is removed)
+    bool settle(unsigned short device_id, unsigned long card_id, unsigned short state_id, unsigned short allow_id, bool& agreed);
+
+private:
+    struct Pair
+    {
+        unsigned long   card_id;                // 0 - free slot
+        unsigned short  device_id;
+        bool            granted;                // optimistic grant waits for server answer
+    };
+
+    // slot of card on reader or nullptr
+    Pair* find(unsigned short device_id, unsigned long card_id);
+
+    Pair            _pairs[ALLOW_SLOTS];
+    uint8_t         _next = 0;                  // slot replaced by next add()
+};
+
+#endif
@@ -0,0 +1,125 @@
+#include "Backends.h"
+
+#define backend_latency_max 30000               // longer samples are cut
+
+void Backends::begin(const Endpoint* endpoints, uint8_t count, uint16_t hedge_min, uint16_t hedge_max)
+{
+    _endpoints = endpoints;
+    _count = min(count, (uint8_t)BACKENDS_MAX);
+    _hedge_min = hedge_min;
+    _hedge_max = hedge_max;
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        _states[i].mean = -1;
+        _states[i].deviation = 0;
+        _states[i].failures = 0;
+        _states[i].check = 0;
+    }
+}
+
+int8_t Backends::select(uint8_t skip)
+{
+    // not measured server counts as the fastest one, so it gets measured
+    int8_t best = -1;
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        if ((skip & (1 << i)) || !healthy(i))
+            continue;
+        if (best < 0 || max(_states[i].mean, (int16_t)0) < max(_states[best].mean, (int16_t)0))
+            best = i;
+    }
+    if (best >= 0 || skip != 0)
+        return best;
+
+    // everything is down: try the least broken one instead of giving up
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        if (best < 0 || _states[i].failures < _states[best].failures)
+            best = i;
+    }
+    return best;
+}
+
+void Backends::sample(uint8_t index, uint32_t latency)
+{
+    State& state = _states[index];
+    int16_t value = min(latency, (uint32_t)backend_latency_max);
+    state.failures = 0;
+    if (state.mean < 0)
+    {
+        state.mean = value;
+        state.deviation = value / 2;
+        return;
+    }
+
+    // deviation 1/4, mean 1/8 (as rtt estimation)
+    int16_t delta = state.mean - value;
+    if (delta < 0)
+        delta = -delta;
+    state.deviation += (delta - state.deviation) / 4;
+    state.mean += (value - state.mean) / 8;
+}
+
+void Backends::failure(uint8_t index)
+{
+    State& state = _states[index];
+    if (state.failures < 255)
+        state.failures++;
+    if (state.failures >= BACKEND_DOWN)
+    {
+        state.check = millis() + ((uint32_t)BACKEND_RETRY << min(state.failures - BACKEND_DOWN, 5));
+    }
+}
+
+int8_t Backends::due()
+{
+    uint32_t now = millis();
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        if (!healthy(i) && (int32_t)(now - _states[i].check) >= 0)
+            return i;
+    }
+    return -1;
+}
+
+void Backends::check(uint8_t index, bool up)
+{
+    if (!up)
+    {
+        failure(index);
+        return;
+    }
+
+    // latency before incident says nothing now: measured again with next lookup
+    _states[index].failures = 0;
+    _states[index].mean = -1;
+    _states[index].deviation = 0;
+}
+
+uint16_t Backends::hedgeDelay(uint8_t index)
+{
+    const State& state = _states[index];
+    if (state.mean < 0)
+        return _hedge_max;
+    return constrain((uint32_t)state.mean + 4 * state.deviation, (uint32_t)_hedge_min, (uint32_t)_hedge_max);
+}
+
+const Backends::Endpoint& Backends::endpoint(uint8_t index)
+{
+    return _endpoints[index];
+}
+
+int16_t Backends::latency(uint8_t index)
+{
+    return _states[index].mean;
+}
+
+bool Backends::healthy(uint8_t index)
+{
+    return _states[index].failures < BACKEND_DOWN;
+}
+
+uint8_t Backends::count()
+{
+    return _count;
+}
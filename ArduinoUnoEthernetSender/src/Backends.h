@@ -0,0 +1,68 @@
+#ifndef BACKENDS_H
+#define BACKENDS_H
+
+#include <Arduino.h>
+
+#define BACKENDS_MAX    4                       // max servers in list
+#define BACKEND_DOWN    2                       // failures in a row after which server is down
+#define BACKEND_RETRY   1000                    // first pause (ms) before health check of down server, doubled up to 32 s
+
+// list of servers with the same database: every server has smoothed latency and health.
+// lookups go to the fastest healthy server, down servers are only health checked until they answer again
+class Backends
+{
+public:
+    struct Endpoint
+    {
+        const char*     host;
+        uint16_t        port;
+    };
+
+    // hedge_min, hedge_max - limits of wait (ms) for answer before the same request goes to another server
+    void begin(const Endpoint* endpoints, uint8_t count, uint16_t hedge_min, uint16_t hedge_max);
+
+    // fastest healthy server which is not in skip mask (bit per server). if there is no healthy server at all,
+    // the one with least failures is returned (only when skip is 0). returns -1 if there is nothing to try
+    int8_t select(uint8_t skip = 0);
+
+    // server answered (or did not answer yet) after latency ms
+    void sample(uint8_t index, uint32_t latency);
+
+    // server did not connect or answer
+    void failure(uint8_t index);
+
+    // down server which should be health checked now (-1 if none)
+    int8_t due();
+
+    // result of health check (connection) of server
+    void check(uint8_t index, bool up);
+
+    // wait (ms) for answer of server before hedged request to the next one
+    uint16_t hedgeDelay(uint8_t index);
+
+    const Endpoint& endpoint(uint8_t index);
+
+    // smoothed latency of server (-1 - not measured yet)
+    int16_t latency(uint8_t index);
+
+    bool healthy(uint8_t index);
+
+    uint8_t count();
+
+private:
+    struct State
+    {
+        int16_t         mean;                   // smoothed latency, ms (-1 - no samples yet)
+        int16_t         deviation;              // smoothed mean deviation, ms
+        uint8_t         failures;               // failures in a row
+        uint32_t        check;                  // time of next health check (down server)
+    };
+
+    const Endpoint* _endpoints = nullptr;
+    State           _states[BACKENDS_MAX];
+    uint8_t         _count = 0;
+    uint16_t        _hedge_min = 0;
+    uint16_t        _hedge_max = 0;
+};
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef BENCH_TRACES_H
+#define BENCH_TRACES_H
+
+#include <Arduino.h>
+
+// traces for benchmark mode. frames have the same layout as on RS485 line between
+// Arduino Nano and Arduino Uno (Channel frame: 0x06 0x85, size, Message, checksum)
+
+// registration of readers 801-804 and their card requests, frames back to back
+const uint8_t bt_bus_requests[] PROGMEM =
+{
+    0x06, 0x85, 0x0A, 0x21, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x28,
+    0x06, 0x85, 0x0A, 0x22, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x2B,
+    0x06, 0x85, 0x0A, 0x23, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x2A,
+    0x06, 0x85, 0x0A, 0x24, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x2D,
+    0x06, 0x85, 0x0A, 0x24, 0x03, 0xC8, 0xE1, 0x00, 0x7F, 0x00, 0x00, 0x00, 0x00, 0x7B,
+    0x06, 0x85, 0x0A, 0x24, 0x03, 0xF6, 0xE5, 0xD4, 0x00, 0x00, 0x00, 0x00, 0x00, 0xEA,
+    0x06, 0x85, 0x0A, 0x24, 0x03, 0x34, 0xAB, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0xA0,
+    0x06, 0x85, 0x0A, 0x22, 0x03, 0xD2, 0xC3, 0xB7, 0x00, 0x00, 0x00, 0x00, 0x00, 0x8D,
+    0x06, 0x85, 0x0A, 0x22, 0x03, 0xE6, 0xF5, 0x01, 0x3A, 0x00, 0x00, 0x00, 0x00, 0x03,
+    0x06, 0x85, 0x0A, 0x22, 0x03, 0x34, 0xAB, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0xA6,
+    0x06, 0x85, 0x0A, 0x21, 0x03, 0x8C, 0x7B, 0x6A, 0x00, 0x00, 0x00, 0x00, 0x00, 0xB5,
+    0x06, 0x85, 0x0A, 0x22, 0x03, 0xC8, 0xE1, 0x00, 0x7F, 0x00, 0x00, 0x00, 0x00, 0x7D,
+    0x06, 0x85, 0x0A, 0x23, 0x03, 0xF1, 0xA2, 0x49, 0x00, 0x00, 0x00, 0x00, 0x00, 0x30,
+    0x06, 0x85, 0x0A, 0x22, 0x03, 0x49, 0x3A, 0x2B, 0x1C, 0x00, 0x00, 0x00, 0x00, 0x6F,
+    0x06, 0x85, 0x0A, 0x23, 0x03, 0xF6, 0xE5, 0xD4, 0x00, 0x00, 0x00, 0x00, 0x00, 0xED,
+    0x06, 0x85, 0x0A, 0x22, 0x03, 0xF1, 0xA2, 0x49, 0x00, 0x00, 0x00, 0x00, 0x00, 0x31,
+};
+
+// server responses (baseadd2.php) for the requests above
+const char bt_json_0[] PROGMEM = "{\"id\":\"4825841\",\"kod\":\"804\",\"status\":1}";
+const char bt_json_1[] PROGMEM = "{\"id\":\"2130764232\",\"kod\":\"804\",\"status\":2}";
+const char bt_json_2[] PROGMEM = "{\"id\":\"12043218\",\"kod\":\"802\",\"status\":5}";
+const char bt_json_3[] PROGMEM = "{\"id\":\"973207014\",\"kod\":\"802\",\"status\":4}";
+const char bt_json_4[] PROGMEM = "{\"id\":\"0\",\"kod\":\"0\",\"status\":0}";
+const char bt_json_5[] PROGMEM = "{\"id\":\"1223476\",\"kod\":\"801\",\"status\":1}";
+const char* const bt_json[] PROGMEM = { bt_json_0, bt_json_1, bt_json_2, bt_json_3, bt_json_4, bt_json_5 };
+
+#endif
@@ -0,0 +1,133 @@
+#include "Benchmark.h"
+#include <BenchTraces.h>
+#include <HttpRequest.h>
+#include <Profiler.h>
+
+#define bench_passes    20                      // passes over every trace
+#define bench_frame     (sizeof(Message) + 4)   // bus frame length (header, size, checksum)
+#define bench_frames    (sizeof(bt_bus_requests) / bench_frame)
+#define bench_jsons     (sizeof(bt_json) / sizeof(bt_json[0]))
+
+void Benchmark::run(Print& out, DeserializationError (*parse)(Stream&, Message&))
+{
+    Profiler::startClock();
+    _channel.begin(&_stream);
+
+    out.println(F("bench\tname\tops\tcycles/op\tops/s"));
+    busReceive(out);
+    busSend(out);
+    jsonParse(out, parse);
+    messageSet(out);
+    requestBuild(out);
+}
+
+void Benchmark::busReceive(Print& out)
+{
+    uint16_t frames = 0;
+    uint32_t cycles = 0;
+
+    for (uint8_t pass = 0; pass < bench_passes; pass++)
+    {
+        _stream.begin(bt_bus_requests, sizeof(bt_bus_requests));
+
+        uint32_t start = Profiler::cycles();
+        while (_stream.available() >= 3)
+        {
+            if (_channel.receive())
+                frames++;
+        }
+        cycles += Profiler::cycles() - start;
+    }
+
+    result(out, F("bus receive"), frames, cycles);
+}
+
+void Benchmark::busSend(Print& out)
+{
+    _stream.begin(nullptr, 0);
+    uint16_t frames = bench_frames * bench_passes;
+
+    uint32_t start = Profiler::cycles();
+    for (uint16_t i = 0; i < frames; i++)
+    {
+        memcpy_P(&_message, bt_bus_requests + (i % bench_frames) * bench_frame + 3, sizeof(Message));
+        _channel.send(_message);
+    }
+    uint32_t cycles = Profiler::cycles() - start;
+
+    result(out, F("bus send"), frames, cycles);
+}
+
+void Benchmark::jsonParse(Print& out, DeserializationError (*parse)(Stream&, Message&))
+{
+    uint16_t responses = 0;
+    uint32_t cycles = 0;
+
+    for (uint8_t pass = 0; pass < bench_passes; pass++)
+    {
+        for (uint8_t i = 0; i < bench_jsons; i++)
+        {
+            const char* json = (const char*)pgm_read_ptr(&bt_json[i]);
+            _stream.begin((const uint8_t*)json, strlen_P(json));
+
+            uint32_t start = Profiler::cycles();
+            DeserializationError error = parse(_stream, _message);
+            cycles += Profiler::cycles() - start;
+
+            if (!error)
+                responses++;
+        }
+    }
+
+    result(out, F("receiveServer json"), responses, cycles);
+}
+
+void Benchmark::messageSet(Print& out)
+{
+    uint16_t calls = bench_frames * bench_passes;
+
+    uint32_t start = Profiler::cycles();
+    for (uint16_t i = 0; i < calls; i++)
+    {
+        _message.set(800 + (i & 0x07), i, i & 0x07, 0);
+    }
+    uint32_t cycles = Profiler::cycles() - start;
+
+    result(out, F("Message::set"), calls, cycles);
+}
+
+void Benchmark::requestBuild(Print& out)
+{
+    uint16_t requests = bench_frames * bench_passes;
+    HttpRequest request;
+
+    uint32_t start = Profiler::cycles();
+    for (uint16_t i = 0; i < requests; i++)
+    {
+        memcpy_P(&_message, bt_bus_requests + (i % bench_frames) * bench_frame + 3, sizeof(Message));
+        request.begin(PSTR("GET /skd.mk/baseadd2.php?"));
+        request.param(PSTR("id="), _message.card_id);
+        request.param(PSTR("&kod="), _message.device_id);
+        request.end("skdmk.fd.mk.ua");
+    }
+    uint32_t cycles = Profiler::cycles() - start;
+
+    result(out, F("sendServer request"), requests, cycles);
+}
+
+void Benchmark::result(Print& out, const __FlashStringHelper* name, uint32_t ops, uint32_t cycles)
+{
+    out.print(F("bench\t"));
+    out.print(name);
+    out.print('\t');
+    out.print(ops);
+    out.print('\t');
+    if (ops == 0 || cycles == 0)
+    {
+        out.println(F("-\t-"));
+        return;
+    }
+    out.print(cycles / ops);
+    out.print('\t');
+    out.println((uint32_t)((float)ops * F_CPU / cycles));
+}
@@ -0,0 +1,42 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <Channel.h>
+#include <MemoryStream.h>
+#include <Message.h>
+
+// throughput benchmarks of protocol and server response hot paths. fed with recorded traces (BenchTraces.h),
+// timed with Timer1 cycles. prints one line per benchmark: name, operations, cycles per operation, operations per second
+class Benchmark
+{
+public:
+    // run all benchmarks. parse - server response parser used by firmware
+    void run(Print& out, DeserializationError (*parse)(Stream&, Message&));
+
+private:
+    // frames per second parsed by Channel::receive() from reader requests trace
+    void busReceive(Print& out);
+
+    // frames per second built by Channel::send() (checksum + stream writes)
+    void busSend(Print& out);
+
+    // server responses per second parsed to message
+    void jsonParse(Print& out, DeserializationError (*parse)(Stream&, Message&));
+
+    // Message::set() calls per second
+    void messageSet(Print& out);
+
+    // lookup requests per second rendered by HttpRequest (without sending)
+    void requestBuild(Print& out);
+
+    // prints result line
+    void result(Print& out, const __FlashStringHelper* name, uint32_t ops, uint32_t cycles);
+
+    Message         _message;
+    Channel<Message> _channel;
+    MemoryStream    _stream;
+};
+
+#endif
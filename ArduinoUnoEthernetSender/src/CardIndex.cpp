@@ -0,0 +1,116 @@
+#include "CardIndex.h"
+
+bool CardIndex::begin(CardIndexRead read, const uint32_t* slots, uint8_t count)
+{
+    _read = read;
+    _header.version = 0;
+    _header.blocks = 0;
+    _top_count = 0;
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        Header header;
+        if (valid(slots[i], header) && (_header.blocks == 0 || header.version > _header.version))
+        {
+            _address = slots[i];
+            _header = header;
+        }
+    }
+    if (_header.blocks == 0)
+        return false;
+
+    _step = (_header.blocks + CARD_INDEX_TOP - 1) / CARD_INDEX_TOP;
+    for (uint16_t block = 0; block < _header.blocks; block += _step)
+        _top[_top_count++] = fence(block);
+    return true;
+}
+
+bool CardIndex::contains(unsigned long card_id)
+{
+    if (_header.blocks == 0)
+        return false;
+
+    if (card_id < _top[0])
+        return false;
+
+    // last RAM sample not greater than card
+    int16_t low = 0, high = _top_count - 1;
+    while (low < high)
+    {
+        int16_t middle = (low + high + 1) / 2;
+        if (_top[middle] <= card_id)
+            low = middle;
+        else
+            high = middle - 1;
+    }
+
+    // the first read: piece of fence after RAM sample, last block which starts not after card
+    uint32_t cards[CARD_INDEX_READ];
+    uint16_t first = low * _step;
+    uint8_t size = min((uint32_t)_step, (uint32_t)_header.blocks - first);
+    _read(_address + sizeof(Header) + (uint32_t)first * 4, cards, size * 4);
+    uint8_t i = 1;
+    while (i < size && cards[i] <= card_id)
+        i++;
+    uint16_t block = first + i - 1;
+
+    // the second read: the block
+    uint8_t block_cards = _header.block_cards;
+    _read(_address + sizeof(Header) + (uint32_t)_header.blocks * 4 + (uint32_t)block * block_cards * 4, cards, block_cards * 4);
+
+    int8_t left = 0, right = block_cards - 1;
+    while (left <= right)
+    {
+        int8_t middle = (left + right) / 2;
+        if (cards[middle] == card_id)
+            return true;
+        if (cards[middle] < card_id)
+            left = middle + 1;
+        else
+            right = middle - 1;
+    }
+    return false;
+}
+
+uint32_t CardIndex::version()
+{
+    return _header.version;
+}
+
+uint32_t CardIndex::count()
+{
+    return _header.blocks == 0 ? 0 : _header.count;
+}
+
+bool CardIndex::valid(uint32_t address, Header& header)
+{
+    _read(address, &header, sizeof(header));
+    if (header.magic != CARD_INDEX_MAGIC || header.blocks == 0
+        || header.block_cards == 0 || header.block_cards > CARD_INDEX_READ
+        || (header.blocks + CARD_INDEX_TOP - 1) / CARD_INDEX_TOP > CARD_INDEX_READ)
+        return false;
+
+    // crc32 (reflected, 0xEDB88320) of fence and blocks, the same as zlib.crc32
+    uint32_t length = (uint32_t)header.blocks * 4 * (1 + header.block_cards);
+    uint32_t crc = 0xFFFFFFFF;
+    uint8_t chunk[32];
+    for (uint32_t offset = 0; offset < length; offset += sizeof(chunk))
+    {
+        uint16_t size = min((uint32_t)sizeof(chunk), length - offset);
+        _read(address + sizeof(Header) + offset, chunk, size);
+        for (uint16_t i = 0; i < size; i++)
+        {
+            crc ^= chunk[i];
+            for (uint8_t bit = 0; bit < 8; bit++)
+                crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+    }
+    return ~crc == header.crc;
+}
+
+uint32_t CardIndex::fence(uint16_t block)
+{
+    uint32_t card;
+    _read(_address + sizeof(Header) + (uint32_t)block * 4, &card, sizeof(card));
+    return card;
+}
@@ -0,0 +1,60 @@
+#ifndef CARD_INDEX_H
+#define CARD_INDEX_H
+
+#include <Arduino.h>
+
+#define CARD_INDEX_MAGIC 0x58444943UL           // 'CIDX'
+#define CARD_INDEX_TOP  32                      // fence samples kept in RAM
+#define CARD_INDEX_READ 40                      // max cards of one read: block or piece of fence (160 bytes of stack)
+
+// reads length bytes of storage (PROGMEM, SPI flash, ...) from address
+typedef void (*CardIndexRead)(uint32_t address, void* buffer, uint16_t length);
+
+// read-only sorted set of card ids built by tools/card_index.py. cards are split into blocks, first card of every
+// block is in fence, every n-th fence entry is in RAM. builder sizes blocks so that piece of fence between RAM samples
+// fits into one read as well as block: lookup is binary search in RAM, one read of fence piece and one read of block
+// (two reads for any size up to CARD_INDEX_TOP * CARD_INDEX_READ^2 = 51200 cards).
+// storage may have several slots (A/B), the valid image with the greatest version is used
+class CardIndex
+{
+public:
+    // image header (little-endian, no padding)
+    struct Header
+    {
+        uint32_t        magic;                  // CARD_INDEX_MAGIC
+        uint32_t        version;
+        uint32_t        count;                  // cards
+        uint16_t        blocks;
+        uint8_t         block_cards;            // cards in block (CARD_INDEX_READ at most)
+        uint8_t         reserved;
+        uint32_t        crc;                    // crc32 of fence and blocks
+    };
+
+    // choose newest valid image of slots (storage addresses). returns false if there is no valid one
+    bool begin(CardIndexRead read, const uint32_t* slots, uint8_t count);
+
+    // returns true if card is in index
+    bool contains(unsigned long card_id);
+
+    // version of used image (0 - no image)
+    uint32_t version();
+
+    // cards in used image
+    uint32_t count();
+
+private:
+    // returns true if slot contains complete image
+    bool valid(uint32_t address, Header& header);
+
+    // first card of block
+    uint32_t fence(uint16_t block);
+
+    CardIndexRead   _read = nullptr;
+    uint32_t        _address = 0;               // start of used image
+    Header          _header = {};
+    uint32_t        _top[CARD_INDEX_TOP];       // fence of every _step-th block
+    uint8_t         _top_count = 0;
+    uint16_t        _step = 1;
+};
+
+#endif
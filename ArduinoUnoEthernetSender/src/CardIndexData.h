@@ -0,0 +1,13 @@
+// generated by tools/card_index.py, do not edit
+// version 0, 0 cards
+#ifndef CARD_INDEX_DATA_H
+#define CARD_INDEX_DATA_H
+
+#include <Arduino.h>
+
+const uint8_t card_index_image[] PROGMEM = {
+    0x43, 0x49, 0x44, 0x58, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+};
+
+#endif
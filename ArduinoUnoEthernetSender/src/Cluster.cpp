@@ -0,0 +1,147 @@
+#include "Cluster.h"
+
+#define cl_hello_period 10000                   // period of announcing gateway to group
+#define cl_peer_timeout 35000                   // peer is forgotten after this time of silence
+
+#define cl_signed       12                      // bytes of message covered by tag
+
+bool Cluster::begin(IPAddress group, uint16_t port, const uint8_t* key, DecisionCache* cache, uint16_t ttl, uint16_t accepted)
+{
+    _group = group;
+    _port = port;
+    _key = key;
+    _cache = cache;
+    _ttl = ttl;
+    _accepted = accepted;
+    for (uint8_t i = 0; i < CLUSTER_PEERS; i++)
+        _peers[i].seen = 0;
+
+    _udp.stop();
+    _ready = _udp.beginMulticast(group, port) == 1;
+    if (_ready)
+    {
+        _hello.begin(cl_hello_period);
+        send(m_hello, 0, 0, 0, 0);
+    }
+    return _ready;
+}
+
+void Cluster::share(unsigned short device_id, unsigned long card_id, unsigned short state_id, uint16_t ttl)
+{
+    send(m_entry, device_id, card_id, state_id, ttl);
+}
+
+void Cluster::invalidate(unsigned long card_id)
+{
+    send(m_invalidate, 0, card_id, 0, 0);
+}
+
+void Cluster::presence(unsigned short device_id, unsigned long card_id, unsigned short state_id, uint8_t direction)
+{
+    send(m_presence, device_id, card_id, state_id, direction);
+}
+
+bool Cluster::update(Packet& passage)
+{
+    if (!_ready)
+        return false;
+
+    if (_hello.update())
+        send(m_hello, 0, 0, 0, 0);
+
+    while (_udp.parsePacket() > 0)
+    {
+        Packet packet;
+        int length = _udp.read((unsigned char*)&packet, sizeof(packet));
+        if (length != sizeof(packet) || packet.magic != CLUSTER_MAGIC)
+            continue;
+        if (!SipHash::verify(_key, (const uint8_t*)&packet, cl_signed, packet.mac))
+        {
+            _rejected++;
+            continue;
+        }
+
+        // own messages may come back from group
+        IPAddress sender = _udp.remoteIP();
+        if (sender == Ethernet.localIP())
+            continue;
+        heard(sender);
+
+        switch (packet.type)
+        {
+        case m_entry:
+            // passage is decided by server (or own cache) only
+            if (packet.state_id >= 16 || !(_accepted & (1U << packet.state_id)))
+            {
+                _rejected++;
+                break;
+            }
+            _cache->put(packet.device_id, packet.card_id, packet.state_id, packet.ttl < _ttl ? packet.ttl : _ttl);
+            break;
+        case m_invalidate:
+            _cache->invalidate(packet.card_id);
+            break;
+        case m_presence:
+            _cache->invalidate(packet.card_id);
+            passage = packet;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint8_t Cluster::peers()
+{
+    uint32_t now = millis();
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < CLUSTER_PEERS; i++)
+    {
+        if (_peers[i].seen != 0 && now - _peers[i].seen < cl_peer_timeout)
+            count++;
+    }
+    return count;
+}
+
+uint16_t Cluster::rejected()
+{
+    return _rejected;
+}
+
+void Cluster::send(uint8_t type, unsigned short device_id, unsigned long card_id, unsigned short state_id, uint16_t ttl)
+{
+    if (!_ready)
+        return;
+
+    Packet packet;
+    packet.magic = CLUSTER_MAGIC;
+    packet.type = type;
+    packet.ttl = ttl;
+    packet.device_id = device_id;
+    packet.card_id = card_id;
+    packet.state_id = state_id;
+    SipHash::sign(_key, (const uint8_t*)&packet, cl_signed, packet.mac);
+
+    _udp.beginPacket(_group, _port);
+    _udp.write((const uint8_t*)&packet, sizeof(packet));
+    _udp.endPacket();
+}
+
+void Cluster::heard(IPAddress ip)
+{
+    uint32_t now = millis() | 1;                // 0 marks free entry
+    Peer* target = &_peers[0];
+    for (uint8_t i = 0; i < CLUSTER_PEERS; i++)
+    {
+        Peer& p = _peers[i];
+        if (p.seen != 0 && p.ip == ip)
+        {
+            target = &p;
+            break;
+        }
+        // free entry or the longest silent peer
+        if (p.seen == 0 || (target->seen != 0 && p.seen < target->seen))
+            target = &p;
+    }
+    target->ip = ip;
+    target->seen = now;
+}
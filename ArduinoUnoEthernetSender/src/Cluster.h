@@ -0,0 +1,91 @@
+#ifndef CLUSTER_H
+#define CLUSTER_H
+
+#include <Arduino.h>
+#include <Ethernet.h>
+#include <EthernetUdp.h>
+#include "DecisionCache.h"
+#include "SipHash.h"
+#include "Timer.h"
+
+#define CLUSTER_MAGIC   0x43                    // first byte of every cluster message
+#define CLUSTER_PEERS   4                       // max remembered gateways
+
+// gateways of one site share server decisions through udp multicast group: decision received from
+// server by one gateway is put to caches of all of them, so the same card is not requested again.
+// messages are best-effort: lost one only costs an extra server request.
+// messages are signed with key of site; peers may only add negative decisions (a forged or wrong one
+// costs a server request or a denial for ttl, never a passage)
+class Cluster
+{
+public:
+    // message layout (little-endian). packed: the same layout on host build
+    struct __attribute__((packed)) Packet
+    {
+        uint8_t         magic;                  // CLUSTER_MAGIC
+        uint8_t         type;
+        uint16_t        ttl;                    // m_entry: seconds decision stays valid; m_presence: direction
+        uint16_t        device_id;
+        uint32_t        card_id;
+        uint16_t        state_id;
+        uint8_t         mac[SIPHASH_TAG];       // siphash-2-4 of fields above
+    };
+
+    enum Type
+    {
+        m_hello         = 1,                    // gateway is alive (periodic, used for discovery)
+        m_entry,                                // decision for card on device (device 0 - any device)
+        m_invalidate,                           // forget decisions about card
+        m_presence                              // card passed device (state - server state), forget decisions about card
+    };
+
+    // join multicast group. key - shared key of site (SIPHASH_KEY bytes), cache receives decisions of peers:
+    // only states of accepted mask (bit per state id) and for ttl seconds at most
+    bool begin(IPAddress group, uint16_t port, const uint8_t* key, DecisionCache* cache, uint16_t ttl, uint16_t accepted);
+
+    // send decision to peers
+    void share(unsigned short device_id, unsigned long card_id, unsigned short state_id, uint16_t ttl);
+
+    // tell peers to forget decisions about card
+    void invalidate(unsigned long card_id);
+
+    // tell peers that card passed device in direction (PresenceTable::Direction)
+    void presence(unsigned short device_id, unsigned long card_id, unsigned short state_id, uint8_t direction);
+
+    // apply messages of peers to cache and announce gateway periodically.
+    // returns true if peer reported card passage (call again while true)
+    bool update(Packet& passage);
+
+    // amount of gateways heard recently
+    uint8_t peers();
+
+    // messages dropped: wrong tag or decision peers may not give
+    uint16_t rejected();
+
+private:
+    struct Peer
+    {
+        IPAddress       ip;
+        uint32_t        seen;                   // millis() of last message (0 - free)
+    };
+
+    // send message to group
+    void send(uint8_t type, unsigned short device_id, unsigned long card_id, unsigned short state_id, uint16_t ttl);
+
+    // remember sender of message
+    void heard(IPAddress ip);
+
+    EthernetUDP     _udp;
+    IPAddress       _group;
+    uint16_t        _port = 0;
+    bool            _ready = false;
+    const uint8_t*  _key = nullptr;
+    DecisionCache*  _cache = nullptr;
+    uint16_t        _ttl = 0;                   // max seconds of peer decision
+    uint16_t        _accepted = 0;              // states peers may give
+    uint16_t        _rejected = 0;
+    Timer           _hello;
+    Peer            _peers[CLUSTER_PEERS];
+};
+
+#endif
@@ -0,0 +1,99 @@
+#include "Coalescer.h"
+
+void Coalescer::begin(uint16_t window)
+{
+    _window = window;
+    for (uint8_t i = 0; i < COALESCE_FLIGHTS; i++)
+        _flights[i].card_id = 0;
+}
+
+Coalescer::Join Coalescer::join(unsigned long card_id, unsigned short device_id, uint8_t segment, unsigned short& state_id)
+{
+    uint32_t now = millis();
+    Flight* slot = nullptr;
+    for (uint8_t i = 0; i < COALESCE_FLIGHTS; i++)
+    {
+        Flight& f = _flights[i];
+        if (free(f, now))
+        {
+            if (slot == nullptr)
+                slot = &f;
+            continue;
+        }
+        if (f.card_id != card_id)
+            continue;
+
+        if (!f.active && f.waiting == 0)
+        {
+            if (f.remembered)
+            {
+                state_id = f.state_id;
+                return c_recent;
+            }
+            // error is not given to new swipes: lookup again
+            slot = &f;
+            break;
+        }
+
+        // no place for one more reader: it makes own lookup
+        if (f.waiting == COALESCE_WAITERS)
+            return c_new;
+
+        f.waiters[f.waiting].device_id = device_id;
+        f.waiters[f.waiting].segment = segment;
+        f.waiting++;
+        return c_joined;
+    }
+
+    // all slots are busy: lookup without coalescing
+    if (slot == nullptr)
+        return c_new;
+
+    slot->card_id = card_id;
+    slot->time = now;
+    slot->active = true;
+    slot->remembered = false;
+    slot->waiting = 0;
+    return c_new;
+}
+
+void Coalescer::finish(unsigned long card_id, unsigned short state_id, bool remember)
+{
+    for (uint8_t i = 0; i < COALESCE_FLIGHTS; i++)
+    {
+        Flight& f = _flights[i];
+        if (f.card_id != card_id || !f.active)
+            continue;
+
+        f.active = false;
+        f.time = millis();
+        f.state_id = state_id;
+        f.remembered = remember;
+        return;
+    }
+}
+
+bool Coalescer::waiter(unsigned long card_id, Waiter& waiter, unsigned short& state_id)
+{
+    for (uint8_t i = 0; i < COALESCE_FLIGHTS; i++)
+    {
+        Flight& f = _flights[i];
+        if (f.card_id != card_id || f.active || f.waiting == 0)
+            continue;
+
+        f.waiting--;
+        waiter = f.waiters[f.waiting];
+        state_id = f.state_id;
+        return true;
+    }
+    return false;
+}
+
+bool Coalescer::free(const Flight& f, uint32_t now)
+{
+    if (f.card_id == 0)
+        return true;
+    if (f.active)
+        return now - f.time >= COALESCE_MAX_FLIGHT;
+    return f.waiting == 0 && now - f.time >= _window;
+}
@@ -0,0 +1,61 @@
+#ifndef COALESCER_H
+#define COALESCER_H
+
+#include <Arduino.h>
+
+#define COALESCE_FLIGHTS 4                      // max cards looked up at once
+#define COALESCE_WAITERS 4                      // max extra readers waiting for one lookup
+#define COALESCE_MAX_FLIGHT 2000                // lookup without finish() is forgotten after this time
+
+// single-flight lookups: swipes of card which is already being looked up wait for that lookup instead of
+// new one, and result is given to every waiting reader. for a short window after lookup the same card gets
+// the same result without server (card held at reader, the same card at adjacent readers)
+class Coalescer
+{
+public:
+    // reader waiting for result
+    struct Waiter
+    {
+        unsigned short  device_id;
+        uint8_t         segment;
+    };
+
+    enum Join
+    {
+        c_new           = 0,                    // nobody looks card up: caller does lookup and calls finish()
+        c_joined,                               // lookup is in flight: reader gets result with waiter()
+        c_recent                                // card was looked up within window: state is the result
+    };
+
+    // window - time (ms) result stays valid for the same card
+    void begin(uint16_t window);
+
+    // register swipe of card on reader (device on bus segment)
+    Join join(unsigned long card_id, unsigned short device_id, uint8_t segment, unsigned short& state_id);
+
+    // lookup of card finished. remember - result may be given during window (errors should not)
+    void finish(unsigned long card_id, unsigned short state_id, bool remember);
+
+    // next reader waiting for card finished with finish(). returns false when there are no more
+    bool waiter(unsigned long card_id, Waiter& waiter, unsigned short& state_id);
+
+private:
+    struct Flight
+    {
+        unsigned long   card_id;                // 0 - free slot
+        uint32_t        time;                   // start of lookup or its finish
+        unsigned short  state_id;
+        bool            active;                 // lookup in flight
+        bool            remembered;             // state may be given during window
+        uint8_t         waiting;
+        Waiter          waiters[COALESCE_WAITERS];
+    };
+
+    // returns true if slot is not used by lookup, its waiters or window
+    bool free(const Flight& f, uint32_t now);
+
+    Flight          _flights[COALESCE_FLIGHTS];
+    uint16_t        _window = 0;
+};
+
+#endif
@@ -0,0 +1,78 @@
+#include "DecisionCache.h"
+
+bool DecisionCache::get(unsigned short device_id, unsigned long card_id, unsigned short& state_id)
+{
+    uint32_t now = millis();
+    for (uint8_t i = 0; i < CACHE_ENTRIES; i++)
+    {
+        Entry& e = _entries[i];
+        if (e.card_id != card_id || !alive(e, now))
+            continue;
+        if (e.device_id != device_id && e.device_id != CACHE_ANY)
+            continue;
+
+        state_id = e.state_id;
+        _hits++;
+        return true;
+    }
+    _misses++;
+    return false;
+}
+
+void DecisionCache::put(unsigned short device_id, unsigned long card_id, unsigned short state_id, uint16_t ttl)
+{
+    if (card_id == 0)
+        return;
+
+    uint32_t now = millis();
+    Entry* target = &_entries[0];
+    for (uint8_t i = 0; i < CACHE_ENTRIES; i++)
+    {
+        Entry& e = _entries[i];
+        if (e.card_id == card_id && e.device_id == device_id)
+        {
+            target = &e;
+            break;
+        }
+        // free entry is better than any taken one, taken - the one expiring first
+        if (!alive(*target, now))
+            continue;
+        if (!alive(e, now) || (int32_t)(e.expires - target->expires) < 0)
+            target = &e;
+    }
+
+    target->card_id = card_id;
+    target->device_id = device_id;
+    target->state_id = state_id;
+    target->expires = now + (uint32_t)ttl * 1000;
+}
+
+void DecisionCache::invalidate(unsigned long card_id)
+{
+    for (uint8_t i = 0; i < CACHE_ENTRIES; i++)
+    {
+        if (_entries[i].card_id == card_id)
+            _entries[i].card_id = 0;
+    }
+}
+
+void DecisionCache::clear()
+{
+    for (uint8_t i = 0; i < CACHE_ENTRIES; i++)
+        _entries[i].card_id = 0;
+}
+
+uint16_t DecisionCache::hits()
+{
+    return _hits;
+}
+
+uint16_t DecisionCache::misses()
+{
+    return _misses;
+}
+
+bool DecisionCache::alive(const Entry& e, uint32_t now)
+{
+    return e.card_id != 0 && (int32_t)(e.expires - now) > 0;
+}
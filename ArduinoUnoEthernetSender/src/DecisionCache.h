@@ -0,0 +1,49 @@
+#ifndef DECISION_CACHE_H
+#define DECISION_CACHE_H
+
+#include <Arduino.h>
+
+#define CACHE_ENTRIES   16                      // max remembered decisions
+#define CACHE_ANY       0                       // device id of decision valid for every device
+
+// recent server decisions, so repeated swipes of the same card are answered without server.
+// decision about card itself (unknown or blocked card) is stored with device id CACHE_ANY
+class DecisionCache
+{
+public:
+    struct Entry
+    {
+        unsigned long   card_id;                // 0 - free entry
+        unsigned short  device_id;
+        unsigned short  state_id;
+        uint32_t        expires;                // millis() when entry becomes invalid
+    };
+
+    // finds not expired decision for card on device. returns false if there is no such
+    bool get(unsigned short device_id, unsigned long card_id, unsigned short& state_id);
+
+    // remember decision for ttl seconds (replaces the same card and device or the oldest entry)
+    void put(unsigned short device_id, unsigned long card_id, unsigned short state_id, uint16_t ttl);
+
+    // forget all decisions about card
+    void invalidate(unsigned long card_id);
+
+    // forget everything
+    void clear();
+
+    // get() calls answered from cache
+    uint16_t hits();
+
+    // get() calls which need server
+    uint16_t misses();
+
+private:
+    // returns true if entry is taken and not expired
+    bool alive(const Entry& e, uint32_t now);
+
+    Entry           _entries[CACHE_ENTRIES];
+    uint16_t        _hits = 0;
+    uint16_t        _misses = 0;
+};
+
+#endif
@@ -0,0 +1,238 @@
+#include "DnsCache.h"
+
+#define dns_port        53
+#define dns_type_a      1
+#define dns_class_in    1
+#define dns_flag_rd     0x0100                  // recursion desired
+#define dns_flag_qr     0x8000                  // message is reply
+#define dns_rcode_mask  0x000F
+
+void DnsCache::begin(const IPAddress& server, uint16_t local_port)
+{
+    _server = server;
+    _local_port = local_port;
+    if (_waiting >= 0)
+    {
+        _udp.stop();
+        _waiting = -1;
+    }
+
+    // new network: everything is queried again, last addresses stay until replies
+    for (uint8_t i = 0; i < _count; i++)
+        _entries[i].refresh = millis();
+}
+
+bool DnsCache::add(const char* host)
+{
+    uint8_t index = _count;
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        if (strcmp(_entries[i].host, host) == 0)
+            index = i;
+    }
+    if (index == DNS_HOSTS)
+        return false;
+    if (index == _count)
+    {
+        Entry& entry = _entries[_count++];
+        entry.host = host;
+        entry.known = false;
+        entry.fixed = entry.address.fromString(host);
+        entry.known = entry.fixed;
+    }
+
+    Entry& entry = _entries[index];
+    if (entry.fixed)
+        return true;
+
+    // resolved at once, later queries only refresh it
+    while (_waiting >= 0)
+        update();
+    if (!query(index))
+        return false;
+    while (!receive());
+    return _answered;
+}
+
+bool DnsCache::get(const char* host, IPAddress& address)
+{
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        if (strcmp(_entries[i].host, host) == 0 && _entries[i].known)
+        {
+            address = _entries[i].address;
+            return true;
+        }
+    }
+    return false;
+}
+
+void DnsCache::update()
+{
+    if (_waiting >= 0)
+    {
+        receive();
+        return;
+    }
+
+    uint32_t now = millis();
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        if (!_entries[i].fixed && (int32_t)(now - _entries[i].refresh) >= 0)
+        {
+            query(i);
+            return;
+        }
+    }
+}
+
+bool DnsCache::query(uint8_t index)
+{
+    const Entry& entry = _entries[index];
+    if (!_udp.begin(_local_port))
+        return false;
+
+    _query_id = micros();
+    if (_udp.beginPacket(_server, dns_port) != 1)
+    {
+        _udp.stop();
+        return false;
+    }
+
+    // header: id, flags, 1 question, no answers, authority and additional records
+    uint8_t header[12] = {
+        (uint8_t)(_query_id >> 8), (uint8_t)_query_id,
+        dns_flag_rd >> 8, dns_flag_rd & 0xFF,
+        0, 1, 0, 0, 0, 0, 0, 0
+    };
+    _udp.write(header, sizeof(header));
+
+    // name as labels: "skdmk.fd.mk.ua" -> 5 skdmk 2 fd 2 mk 2 ua 0
+    const char* label = entry.host;
+    while (*label)
+    {
+        const char* dot = strchr(label, '.');
+        uint8_t length = dot ? dot - label : strlen(label);
+        _udp.write(length);
+        _udp.write((const uint8_t*)label, length);
+        label += length;
+        if (*label == '.')
+            label++;
+    }
+    uint8_t question[5] = { 0, 0, dns_type_a, 0, dns_class_in };
+    _udp.write(question, sizeof(question));
+
+    if (_udp.endPacket() != 1)
+    {
+        _udp.stop();
+        return false;
+    }
+
+    _waiting = index;
+    _sent = millis();
+    return true;
+}
+
+bool DnsCache::receive()
+{
+    Entry& entry = _entries[_waiting];
+    bool answered = false;
+    uint32_t ttl = 0;
+
+    if (_udp.parsePacket() >= 12 && read16() == _query_id)
+    {
+        uint16_t flags = read16();
+        uint16_t questions = read16();
+        uint16_t answers = read16();
+        read32();                               // authority and additional records
+
+        if ((flags & dns_flag_qr) && (flags & dns_rcode_mask) == 0)
+        {
+            for (uint16_t i = 0; i < questions; i++)
+            {
+                skipName();
+                read32();                       // type and class
+            }
+
+            // first A record (CNAME records before it are skipped)
+            for (uint16_t i = 0; i < answers && !answered && _udp.available(); i++)
+            {
+                skipName();
+                uint16_t type = read16();
+                uint16_t record_class = read16();
+                uint32_t record_ttl = read32();
+                uint16_t length = read16();
+                if (type == dns_type_a && record_class == dns_class_in && length == 4)
+                {
+                    for (uint8_t b = 0; b < 4; b++)
+                        entry.address[b] = read8();
+                    ttl = record_ttl;
+                    answered = true;
+                }
+                else
+                {
+                    while (length-- > 0)
+                        read8();
+                }
+            }
+        }
+        _udp.flush();
+    }
+    else if (millis() - _sent < DNS_TIMEOUT)
+    {
+        return false;
+    }
+
+    // no answer: old address stays in use, query is repeated later
+    _answered = answered;
+    if (answered)
+    {
+        entry.known = true;
+        ttl = constrain(ttl, (uint32_t)DNS_TTL_MIN, (uint32_t)DNS_TTL_MAX);
+        entry.refresh = millis() + ttl * 750;
+    }
+    else
+    {
+        entry.refresh = millis() + DNS_RETRY;
+    }
+
+    _udp.stop();
+    _waiting = -1;
+    return true;
+}
+
+uint8_t DnsCache::read8()
+{
+    int value = _udp.read();
+    return value < 0 ? 0 : value;
+}
+
+uint16_t DnsCache::read16()
+{
+    uint16_t value = read8() << 8;
+    return value | read8();
+}
+
+uint32_t DnsCache::read32()
+{
+    uint32_t value = (uint32_t)read16() << 16;
+    return value | read16();
+}
+
+void DnsCache::skipName()
+{
+    // labels end with 0 or with 2-byte pointer to name before
+    while (_udp.available())
+    {
+        uint8_t length = read8();
+        if (length == 0)
+            return;
+        if ((length & 0xC0) == 0xC0)
+        {
+            read8();
+            return;
+        }
+        while (length-- > 0)
+            read8();
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef DNS_CACHE_H
+#define DNS_CACHE_H
+
+#include <Arduino.h>
+#include <Ethernet.h>
+#include <EthernetUdp.h>
+
+#define DNS_HOSTS       4                       // max cached hosts
+#define DNS_TTL_MIN     60                      // min seconds between refreshes (short ttl is raised)
+#define DNS_TTL_MAX     86400                   // max seconds between refreshes
+#define DNS_TIMEOUT     2000                    // wait (ms) for reply of dns server
+#define DNS_RETRY       10000                   // pause (ms) before next query after failed one
+
+// addresses of server hosts resolved once and refreshed in background (at 3/4 of ttl), so connection to server
+// never waits for dns. when dns server does not answer, the last known address is used as long as needed
+class DnsCache
+{
+public:
+    // dns server and local udp port of queries (socket is open only while query is waiting)
+    void begin(const IPAddress& server, uint16_t local_port);
+
+    // add host (string must live as long as cache) and resolve it now (blocking, DNS_TIMEOUT at most).
+    // returns false if host was not resolved, it is tried again in background
+    bool add(const char* host);
+
+    // last known address of host. returns false if host is not cached or was never resolved
+    bool get(const char* host, IPAddress& address);
+
+    // background refresh: sends one query when host is due and takes its reply (non-blocking)
+    void update();
+
+private:
+    struct Entry
+    {
+        const char*     host;
+        IPAddress       address;
+        uint32_t        refresh;                // time of next query
+        bool            known;                  // address was resolved at least once
+        bool            fixed;                  // host is ip address itself (never queried)
+    };
+
+    // send query for entry
+    bool query(uint8_t index);
+
+    // take reply of waiting query. returns true when query is finished (answered or not)
+    bool receive();
+
+    uint8_t read8();
+    uint16_t read16();
+    uint32_t read32();
+    void skipName();
+
+    EthernetUDP     _udp;
+    IPAddress       _server;
+    uint16_t        _local_port = 0;
+    Entry           _entries[DNS_HOSTS];
+    uint8_t         _count = 0;
+    int8_t          _waiting = -1;              // entry of query waiting for reply
+    uint16_t        _query_id = 0;
+    uint32_t        _sent = 0;
+    bool            _answered = false;          // last finished query got address
+};
+
+#endif
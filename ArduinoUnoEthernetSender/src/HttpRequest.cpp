@@ -0,0 +1,92 @@
+#include "HttpRequest.h"
+
+// 32-bit division is a library call of hundreds of cycles on AVR, digits are found by subtraction instead
+const unsigned long http_powers[] PROGMEM = {
+    1000000000UL, 100000000UL, 10000000UL, 1000000UL, 100000UL, 10000UL, 1000UL, 100UL, 10UL, 1UL
+};
+
+const char http_host[] PROGMEM = " HTTP/1.1\r\nHost: ";
+const char http_close[] PROGMEM = "\r\nConnection: close\r\n\r\n\r\n";
+
+void HttpRequest::begin(const char* line_P)
+{
+    _length = 0;
+    _overflow = false;
+    append_P(line_P);
+}
+
+void HttpRequest::param(const char* name_P, unsigned long value)
+{
+    append_P(name_P);
+    number(value);
+}
+
+void HttpRequest::text(const char* text_P)
+{
+    append_P(text_P);
+}
+
+void HttpRequest::end(const char* host)
+{
+    append_P(http_host);
+    append(host);
+    append_P(http_close);
+}
+
+bool HttpRequest::send(Print& out)
+{
+    if (_overflow)
+        return false;
+    return out.write((const uint8_t*)_buffer, _length) == _length;
+}
+
+const char* HttpRequest::data()
+{
+    return _buffer;
+}
+
+uint8_t HttpRequest::length()
+{
+    return _length;
+}
+
+void HttpRequest::append(char c)
+{
+    if (_length < HTTP_REQUEST_SIZE)
+        _buffer[_length++] = c;
+    else
+        _overflow = true;
+}
+
+void HttpRequest::append(const char* text)
+{
+    while (*text)
+        append(*text++);
+}
+
+void HttpRequest::append_P(const char* text_P)
+{
+    char c;
+    while ((c = pgm_read_byte(text_P++)))
+        append(c);
+}
+
+void HttpRequest::number(unsigned long value)
+{
+    bool started = false;
+    for (uint8_t i = 0; i < sizeof(http_powers) / sizeof(http_powers[0]); i++)
+    {
+        unsigned long power = pgm_read_dword(&http_powers[i]);
+        char digit = '0';
+        while (value >= power)
+        {
+            value -= power;
+            digit++;
+        }
+        if (digit != '0' || started || power == 1)
+        {
+            append(digit);
+            started = true;
+        }
+    }
+}
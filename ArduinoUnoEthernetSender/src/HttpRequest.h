@@ -0,0 +1,42 @@
+#ifndef HTTP_REQUEST_H
+#define HTTP_REQUEST_H
+
+#include <Arduino.h>
+
+#define HTTP_REQUEST_SIZE 192                   // max request length (request line, params, headers)
+
+// GET request rendered into one buffer and sent by one write (one SPI burst and one TCP segment on W5x00
+// instead of one per print). constant parts are PROGMEM strings, numbers are formatted without division
+class HttpRequest
+{
+public:
+    // start request: request line up to query (PROGMEM, e.g. PSTR("GET /path?"))
+    void begin(const char* line_P);
+
+    // query parameter (PROGMEM name with separator and '=', e.g. PSTR("&kod="))
+    void param(const char* name_P, unsigned long value);
+
+    // query text (PROGMEM, e.g. PSTR("&hedge=1"))
+    void text(const char* text_P);
+
+    // end of request line and headers (Host, Connection: close)
+    void end(const char* host);
+
+    // send request by one write. returns false if request did not fit into buffer or was not sent
+    bool send(Print& out);
+
+    const char* data();
+    uint8_t length();
+
+private:
+    void append(char c);
+    void append(const char* text);
+    void append_P(const char* text_P);
+    void number(unsigned long value);
+
+    char            _buffer[HTTP_REQUEST_SIZE];
+    uint8_t         _length = 0;
+    bool            _overflow = false;
+};
+
+#endif
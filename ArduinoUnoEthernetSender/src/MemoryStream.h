@@ -0,0 +1,71 @@
+#ifndef MEMORY_STREAM_H
+#define MEMORY_STREAM_H
+
+#include <Arduino.h>
+
+// stream for reading constant byte array from flash (PROGMEM). can loop data infinitely.
+// written bytes are not stored, only counted, so stream can be used as sink
+class MemoryStream : public Stream
+{
+public:
+    // set data source (PROGMEM array) and start reading from it's beginning
+    void begin(const uint8_t* data, uint16_t length, bool loop = false)
+    {
+        _data = data;
+        _length = length;
+        _position = 0;
+        _loop = loop;
+        _written = 0;
+    }
+
+    // start reading from the beginning
+    void rewind()
+    {
+        _position = 0;
+    }
+
+    int available()
+    {
+        if (_loop && _length > 0)
+            return _length;
+        return _length - _position;
+    }
+
+    int read()
+    {
+        int value = peek();
+        if (value >= 0 && ++_position >= _length && _loop)
+            _position = 0;
+        return value;
+    }
+
+    int peek()
+    {
+        if (_position >= _length)
+            return -1;
+        return pgm_read_byte(_data + _position);
+    }
+
+    size_t write(uint8_t)
+    {
+        _written++;
+        return 1;
+    }
+
+    using Print::write;
+
+    // amount of bytes written to stream since begin()
+    uint32_t written()
+    {
+        return _written;
+    }
+
+private:
+    const uint8_t*  _data = nullptr;
+    uint16_t        _length = 0;
+    uint16_t        _position = 0;
+    bool            _loop = false;
+    uint32_t        _written = 0;
+};
+
+#endif
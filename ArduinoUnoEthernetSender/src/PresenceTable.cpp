@@ -0,0 +1,87 @@
+#include "PresenceTable.h"
+
+void PresenceTable::begin(uint16_t forget)
+{
+    _forget = forget;
+    clear();
+}
+
+bool PresenceTable::allows(unsigned long card_id, uint8_t direction)
+{
+    if (direction == d_none)
+        return true;
+
+    Passage p;
+    return !find(card_id, p) || p.direction != direction;
+}
+
+void PresenceTable::pass(unsigned long card_id, unsigned short device_id, uint8_t direction)
+{
+    if (card_id == 0 || direction == d_none)
+        return;
+
+    uint16_t now = minute();
+    uint8_t index = home(card_id);
+    Passage* target = nullptr;
+    for (uint8_t i = 0; i < PRESENCE_PROBES; i++)
+    {
+        Passage& p = _slots[(index + i) & (PRESENCE_SLOTS - 1)];
+        if (p.card_id == card_id)
+        {
+            target = &p;
+            break;
+        }
+        // free or forgotten slot is better than any fresh one, fresh - the oldest
+        if (target != nullptr && !fresh(*target, now))
+            continue;
+        if (target == nullptr || !fresh(p, now) || (uint16_t)(now - p.minute) > (uint16_t)(now - target->minute))
+            target = &p;
+    }
+
+    target->card_id = card_id;
+    target->device_id = device_id;
+    target->minute = now;
+    target->direction = direction;
+}
+
+bool PresenceTable::find(unsigned long card_id, Passage& passage)
+{
+    uint16_t now = minute();
+    uint8_t index = home(card_id);
+    for (uint8_t i = 0; i < PRESENCE_PROBES; i++)
+    {
+        const Passage& p = _slots[(index + i) & (PRESENCE_SLOTS - 1)];
+        if (p.card_id == 0)
+            return false;
+        if (p.card_id != card_id)
+            continue;
+        if (!fresh(p, now))
+            return false;
+
+        passage = p;
+        return true;
+    }
+    return false;
+}
+
+void PresenceTable::clear()
+{
+    for (uint8_t i = 0; i < PRESENCE_SLOTS; i++)
+        _slots[i].card_id = 0;
+}
+
+uint8_t PresenceTable::home(unsigned long card_id)
+{
+    // fibonacci hashing: top bits of product are well mixed even for sequential card numbers
+    return (uint8_t)((card_id * 2654435761UL) >> 24) & (PRESENCE_SLOTS - 1);
+}
+
+bool PresenceTable::fresh(const Passage& p, uint16_t now)
+{
+    return p.card_id != 0 && (uint16_t)(now - p.minute) < _forget;
+}
+
+uint16_t PresenceTable::minute()
+{
+    return millis() / 60000;
+}
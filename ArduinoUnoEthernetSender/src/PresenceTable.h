@@ -0,0 +1,59 @@
+#ifndef PRESENCE_TABLE_H
+#define PRESENCE_TABLE_H
+
+#include <Arduino.h>
+
+#define PRESENCE_SLOTS  32                      // table size (power of 2)
+#define PRESENCE_PROBES 8                       // max slots checked for one card
+
+// last passage of every card seen recently (direction, reader, time) for local anti-passback.
+// open addressing with linear probing; slots are never emptied, stale ones are reused,
+// so when probe window is full the oldest passage is replaced
+class PresenceTable
+{
+public:
+    enum Direction
+    {
+        d_none          = 0,                    // reader without direction (no anti-passback)
+        d_in,                                   // entrance reader
+        d_out                                   // exit reader
+    };
+
+    struct Passage
+    {
+        unsigned long   card_id;                // 0 - free slot
+        unsigned short  device_id;
+        uint16_t        minute;                 // millis() / 60000 of passage
+        uint8_t         direction;
+    };
+
+    // passages older than forget minutes are ignored (presence of card becomes unknown)
+    void begin(uint16_t forget);
+
+    // returns false if card passing in direction breaks anti-passback (enters twice or exits twice)
+    bool allows(unsigned long card_id, uint8_t direction);
+
+    // remember passage of card
+    void pass(unsigned long card_id, unsigned short device_id, uint8_t direction);
+
+    // last passage of card. returns false if there is no fresh one
+    bool find(unsigned long card_id, Passage& passage);
+
+    // forget everything
+    void clear();
+
+private:
+    // first slot of card probe window
+    uint8_t home(unsigned long card_id);
+
+    // returns true if passage is taken and not forgotten yet
+    bool fresh(const Passage& p, uint16_t now);
+
+    // current time in minutes
+    uint16_t minute();
+
+    Passage         _slots[PRESENCE_SLOTS];
+    uint16_t        _forget = 0xFFFF;
+};
+
+#endif
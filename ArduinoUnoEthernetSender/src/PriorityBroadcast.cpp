@@ -0,0 +1,195 @@
+#include "PriorityBroadcast.h"
+#include <EEPROM.h>
+
+#define pb_incomplete   0xFFFF                  // fanout of result when not every reader acknowledged
+#define pb_signed       6                       // bytes of command covered by tag (magic, command, nonce)
+
+bool PriorityBroadcast::begin(uint16_t port, uint16_t repeat, uint8_t tries, const uint8_t* key, const IPAddress& admin, int nonce_address)
+{
+    _repeat = repeat;
+    _tries = tries;
+    _key = key;
+    _admin = admin;
+    _nonce_address = nonce_address;
+    EEPROM.get(_nonce_address, _nonce);
+
+    // erased EEPROM: every nonce is greater
+    if (_nonce == 0xFFFFFFFF)
+        _nonce = 0;
+
+    // readers remember last sequence: after restart of gateway it should not start from the same one
+    if (_sequence == 0)
+        _sequence = micros();
+
+    _udp.stop();
+    _ready = _udp.begin(port) == 1;
+    return _ready;
+}
+
+bool PriorityBroadcast::receive(uint8_t& command)
+{
+    if (!_ready)
+        return false;
+
+    while (_udp.parsePacket() > 0)
+    {
+        Command packet;
+        int length = _udp.read((unsigned char*)&packet, sizeof(packet));
+        if (length != sizeof(packet) || packet.magic != PRIORITY_MAGIC)
+            continue;
+        if (!authentic(packet))
+        {
+            _rejected++;
+            continue;
+        }
+
+        // result of previous command is not waited for any more
+        if (_active)
+        {
+            _incomplete++;
+            finish();
+        }
+
+        _sender = _udp.remoteIP();
+        _sender_port = _udp.remotePort();
+        command = packet.command;
+        return true;
+    }
+    return false;
+}
+
+uint16_t PriorityBroadcast::start(uint8_t command, uint16_t readers)
+{
+    if (_active)
+    {
+        _incomplete++;
+        finish();
+    }
+
+    _sequence++;
+    if (_sequence == 0)
+        _sequence = 1;
+    _command = command;
+    _pending = readers;
+    _sent = 0;
+    _active = true;
+    return _sequence;
+}
+
+bool PriorityBroadcast::due()
+{
+    if (!_active)
+        return false;
+
+    if (_sent == 0)
+    {
+        _sent = 1;
+        _started = millis();
+        _timer.begin(_repeat);
+
+        // nobody has to acknowledge: one frame is the whole fan-out
+        if (_pending == 0)
+        {
+            _fanout = 0;
+            finish();
+        }
+        return true;
+    }
+
+    if (!_timer.update())
+        return false;
+
+    if (_sent >= _tries)
+    {
+        _incomplete++;
+        finish();
+        return false;
+    }
+    _sent++;
+    return true;
+}
+
+bool PriorityBroadcast::ack(uint16_t sequence, uint16_t readers)
+{
+    if (!_active || sequence != _sequence)
+        return false;
+
+    _pending &= ~readers;
+    if (_pending != 0)
+        return false;
+
+    uint32_t elapsed = millis() - _started;
+    _fanout = elapsed < pb_incomplete ? elapsed : pb_incomplete - 1;
+    if (_fanout > _longest)
+        _longest = _fanout;
+    finish();
+    return true;
+}
+
+bool PriorityBroadcast::active()
+{
+    return _active;
+}
+
+uint8_t PriorityBroadcast::command()
+{
+    return _command;
+}
+
+uint16_t PriorityBroadcast::sequence()
+{
+    return _sequence;
+}
+
+uint16_t PriorityBroadcast::fanout()
+{
+    return _fanout;
+}
+
+uint16_t PriorityBroadcast::longest()
+{
+    return _longest;
+}
+
+uint16_t PriorityBroadcast::incomplete()
+{
+    return _incomplete;
+}
+
+uint16_t PriorityBroadcast::rejected()
+{
+    return _rejected;
+}
+
+bool PriorityBroadcast::authentic(const Command& command)
+{
+    if (_admin != IPAddress(0, 0, 0, 0) && _udp.remoteIP() != _admin)
+        return false;
+
+    if (!SipHash::verify(_key, (const uint8_t*)&command, pb_signed, command.mac) || command.nonce <= _nonce)
+        return false;
+
+    _nonce = command.nonce;
+    EEPROM.put(_nonce_address, _nonce);
+    return true;
+}
+
+void PriorityBroadcast::finish()
+{
+    _active = false;
+    _timer.stop();
+    if (!_ready || _sender_port == 0)
+        return;
+
+    Packet packet;
+    packet.magic = PRIORITY_MAGIC;
+    packet.command = _command;
+    packet.sequence = _sequence;
+    packet.fanout = _pending == 0 ? _fanout : pb_incomplete;
+    packet.missing = _pending;
+
+    _udp.beginPacket(_sender, _sender_port);
+    _udp.write((const uint8_t*)&packet, sizeof(packet));
+    _udp.endPacket();
+    _sender_port = 0;
+}
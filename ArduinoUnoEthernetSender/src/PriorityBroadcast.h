@@ -0,0 +1,106 @@
+#ifndef PRIORITY_BROADCAST_H
+#define PRIORITY_BROADCAST_H
+
+#include <Arduino.h>
+#include <Ethernet.h>
+#include <EthernetUdp.h>
+#include "SipHash.h"
+#include "Timer.h"
+
+#define PRIORITY_MAGIC  0x50                    // first byte of every command datagram
+
+// site-wide command (unlock all, lockdown, cache flush) sent to readers before any other bus traffic.
+// frame is repeated under the same sequence until every registered reader acknowledged it or tries are over;
+// time from the first frame to the last acknowledgement is the fan-out time. commands come as udp datagrams signed
+// with shared key, sender gets the result back (tools/priority_command.py)
+class PriorityBroadcast
+{
+public:
+    // command datagram (little-endian, no padding). nonce has to be greater than nonce of every accepted command
+    // (it is kept in EEPROM, so captured datagram is not accepted again after restart either)
+    struct Command
+    {
+        uint8_t         magic;                  // PRIORITY_MAGIC
+        uint8_t         command;
+        uint32_t        nonce;
+        uint8_t         mac[SIPHASH_TAG];       // siphash-2-4 of magic, command and nonce
+    };
+
+    // result datagram
+    struct Packet
+    {
+        uint8_t         magic;                  // PRIORITY_MAGIC
+        uint8_t         command;
+        uint16_t        sequence;               // sequence of frames
+        uint16_t        fanout;                 // ms till the last acknowledgement (0xFFFF - not acknowledged by all)
+        uint16_t        missing;                // registry positions of readers which did not acknowledge
+    };
+
+    // open local socket for commands. repeat - ms between frames, tries - max frames of one command, key - shared key
+    // of SIPHASH_KEY bytes, admin - the only host commands are taken from (0.0.0.0 - any), nonce_address - EEPROM
+    // address of last accepted nonce (4 bytes)
+    bool begin(uint16_t port, uint16_t repeat, uint8_t tries, const uint8_t* key, const IPAddress& admin, int nonce_address);
+
+    // command came from network. returns true once per datagram
+    bool receive(uint8_t& command);
+
+    // start fan-out of command (unfinished one is given up). readers - registry positions which have to acknowledge.
+    // returns sequence of frames
+    uint16_t start(uint8_t command, uint16_t readers);
+
+    // frame has to be sent now (the first one or repeat)
+    bool due();
+
+    // readers (registry positions) acknowledged sequence. returns true if fan-out is complete now
+    bool ack(uint16_t sequence, uint16_t readers);
+
+    // fan-out is in progress
+    bool active();
+
+    // command and sequence of current (or last) fan-out
+    uint8_t command();
+    uint16_t sequence();
+
+    // ms of last complete fan-out and the longest one
+    uint16_t fanout();
+    uint16_t longest();
+
+    // fan-outs given up without all acknowledgements
+    uint16_t incomplete();
+
+    // datagrams dropped: wrong source, tag or replayed nonce
+    uint16_t rejected();
+
+private:
+    // datagram is from admin, signed with key and not replayed
+    bool authentic(const Command& command);
+
+    // fan-out is over: result goes to sender of command
+    void finish();
+
+    EthernetUDP     _udp;
+    bool            _ready = false;
+    IPAddress       _sender;
+    uint16_t        _sender_port = 0;           // 0 - command was not from network
+    const uint8_t*  _key = nullptr;
+    IPAddress       _admin;
+    int             _nonce_address = 0;
+    uint32_t        _nonce = 0;                 // nonce of last accepted command
+    uint16_t        _rejected = 0;
+
+    Timer           _timer;
+    uint16_t        _repeat = 0;
+    uint8_t         _tries = 0;                 // max frames
+    uint8_t         _sent = 0;                  // frames of current fan-out
+
+    bool            _active = false;
+    uint8_t         _command = 0;
+    uint16_t        _sequence = 0;
+    uint16_t        _pending = 0;               // registry positions not acknowledged yet
+    uint32_t        _started = 0;
+    uint16_t        _fanout = 0;
+    uint16_t        _longest = 0;
+    uint16_t        _incomplete = 0;
+};
+
+#endif
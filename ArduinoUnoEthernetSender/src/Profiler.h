@@ -0,0 +1,56 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+
+#define PROFILER_SLOTS  8                       // max amount of measured code paths
+
+// cycle-accurate profiler based on free-running Timer1 (no prescaler, 1 tick = 1 cpu cycle).
+// Timer1 overflows are counted in interrupt, so measured intervals can be up to 2^32 cycles.
+// works the same way on real board and under simulator (simavr), results are printed to any Print
+class Profiler
+{
+public:
+    // cycles statistics of one measured code path
+    struct Slot
+    {
+        uint32_t count;
+        uint32_t total;
+        uint32_t min;
+        uint32_t max;
+    };
+
+    // start Timer1 counting and calibrate start()/stop() overhead
+    void begin();
+
+    // start Timer1 counting only (enough for using cycles())
+    static void startClock();
+
+    // returns cycles passed since startClock()
+    static uint32_t cycles();
+
+    // counts Timer1 overflow. called from TIMER1_OVF_vect of firmware, the vector is defined only in builds using Profiler
+    static void overflow() { _overflows++; }
+
+    // remember start point of slot
+    void start(uint8_t slot);
+
+    // add cycles passed since start() of slot to its statistics
+    void stop(uint8_t slot);
+
+    // clear all statistics
+    void reset();
+
+    // prints statistics of slots. names - array of PROGMEM strings, baselines - PROGMEM array of
+    // reference mean cycles (0 - no baseline). slower than baseline more than tolerance (%) is marked
+    void report(Print& out, const char* const* names, const uint32_t* baselines, uint8_t count, uint8_t tolerance);
+
+private:
+    static volatile uint16_t _overflows;        // high word of cycle counter
+
+    Slot        _slots[PROFILER_SLOTS];
+    uint32_t    _started[PROFILER_SLOTS];
+    uint16_t    _overhead = 0;
+};
+
+#endif
@@ -0,0 +1,179 @@
+#include "ReaderRegistry.h"
+
+bool ReaderRegistry::join(unsigned short device_id, uint8_t segment)
+{
+    bool known;
+    Reader& reader = entry(device_id, known);
+    touch(reader, segment);
+    return !known;
+}
+
+void ReaderRegistry::seen(unsigned short device_id, uint8_t segment)
+{
+    bool known;
+    Reader& reader = entry(device_id, known);
+    touch(reader, segment);
+}
+
+bool ReaderRegistry::status(unsigned short device_id, uint8_t segment, unsigned short status)
+{
+    bool known;
+    Reader& reader = entry(device_id, known);
+    bool changed = !known || reader.status != status;
+    touch(reader, segment);
+    reader.status = status;
+    return changed;
+}
+
+const ReaderRegistry::Reader* ReaderRegistry::find(unsigned short device_id)
+{
+    for (uint8_t i = 0; i < REGISTRY_READERS; i++)
+    {
+        if (_readers[i].device_id == device_id)
+            return &_readers[i];
+    }
+    return nullptr;
+}
+
+int8_t ReaderRegistry::position(unsigned short device_id)
+{
+    for (uint8_t i = 0; i < REGISTRY_READERS; i++)
+    {
+        if (_readers[i].device_id == device_id)
+            return i;
+    }
+    return -1;
+}
+
+void ReaderRegistry::clear()
+{
+    memset(_readers, 0, sizeof(_readers));
+}
+
+const ReaderRegistry::Reader& ReaderRegistry::reader(uint8_t index)
+{
+    return _readers[index];
+}
+
+uint8_t ReaderRegistry::size()
+{
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < REGISTRY_READERS; i++)
+    {
+        if (_readers[i].device_id != 0)
+            count++;
+    }
+    return count;
+}
+
+void ReaderRegistry::group(unsigned short base, uint8_t heads)
+{
+    for (uint8_t i = 0; i < REGISTRY_READERS; i++)
+    {
+        if (_readers[i].device_id >= base && _readers[i].device_id < base + heads)
+            _readers[i].base = base;
+    }
+}
+
+void ReaderRegistry::expire(uint32_t timeout, uint32_t window, uint8_t flaps)
+{
+    uint32_t now = millis();
+    bool window_end = now - _window >= window;
+    if (window_end)
+        _window = now;
+
+    for (uint8_t i = 0; i < REGISTRY_READERS; i++)
+    {
+        Reader& reader = _readers[i];
+        if (reader.device_id == 0)
+            continue;
+
+        bool silent = now - reader.seen > timeout;
+        if (window_end)
+        {
+            reader.drops = 0;
+            if (reader.liveness == l_flapping)
+            {
+                reader.liveness = silent ? l_dead : l_alive;
+                reader.changed = true;
+            }
+        }
+
+        if (reader.liveness == l_alive && silent)
+        {
+            reader.drops++;
+            reader.liveness = reader.drops >= flaps ? l_flapping : l_dead;
+            reader.changed = true;
+        }
+    }
+}
+
+bool ReaderRegistry::changed(uint8_t& index)
+{
+    for (uint8_t i = 0; i < REGISTRY_READERS; i++)
+    {
+        if (_readers[i].device_id != 0 && _readers[i].changed)
+        {
+            _readers[i].changed = false;
+            index = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint8_t ReaderRegistry::count(Liveness liveness)
+{
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < REGISTRY_READERS; i++)
+    {
+        if (_readers[i].device_id != 0 && _readers[i].liveness == liveness)
+            count++;
+    }
+    return count;
+}
+
+ReaderRegistry::Reader& ReaderRegistry::entry(unsigned short device_id, bool& known)
+{
+    uint32_t now = millis();
+    uint8_t oldest = 0;
+    int8_t free = -1;
+    for (uint8_t i = 0; i < REGISTRY_READERS; i++)
+    {
+        if (_readers[i].device_id == device_id)
+        {
+            known = true;
+            return _readers[i];
+        }
+        if (_readers[i].device_id == 0 && free < 0)
+            free = i;
+        if (now - _readers[i].seen > now - _readers[oldest].seen)
+            oldest = i;
+    }
+
+    known = false;
+    Reader& reader = _readers[free >= 0 ? free : oldest];
+    memset(&reader, 0, sizeof(reader));
+    reader.device_id = device_id;
+    reader.base = device_id;
+    return reader;
+}
+
+void ReaderRegistry::touch(Reader& reader, uint8_t segment)
+{
+    uint32_t now = millis();
+    reader.segment = segment;
+    for (uint8_t i = 0; i < REGISTRY_READERS; i++)
+    {
+        Reader& head = _readers[i];
+        if (head.device_id == 0 || (&head != &reader && head.base != reader.base))
+            continue;
+
+        head.seen = now;
+        if (head.liveness == l_dead)
+        {
+            head.liveness = l_alive;
+            head.changed = true;
+        }
+    }
+}
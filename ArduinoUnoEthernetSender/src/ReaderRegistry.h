@@ -0,0 +1,80 @@
+#ifndef READER_REGISTRY_H
+#define READER_REGISTRY_H
+
+#include <Arduino.h>
+
+#define REGISTRY_READERS 16                     // max known reader heads (the oldest silent one is replaced)
+
+// reader heads known by gateway: bus segment, last status, time of last frame and liveness.
+// filled by registration, heartbeat and status frames, which never go to server. every frame of reader is its heartbeat,
+// heads of one reader share it
+class ReaderRegistry
+{
+public:
+    enum Liveness
+    {
+        l_alive         = 0,
+        l_dead,                                 // silent longer than timeout
+        l_flapping                              // died too often during window, changes are not reported till its end
+    };
+
+    struct Reader
+    {
+        unsigned short  device_id;              // 0 - free slot
+        unsigned short  base;                   // device id of first head of reader
+        uint8_t         segment;                // bus segment of reader
+        unsigned short  status;                 // last reported status
+        uint32_t        seen;                   // time of last frame
+        uint8_t         liveness;               // Liveness
+        uint8_t         drops;                  // deaths during flap window
+        bool            changed;                // liveness change is not reported yet
+    };
+
+    // reader registered (started). returns false if it was already known (restart)
+    bool join(unsigned short device_id, uint8_t segment);
+
+    // any frame of reader (heartbeat, card)
+    void seen(unsigned short device_id, uint8_t segment);
+
+    // status of reader. returns true if it differs from last one
+    bool status(unsigned short device_id, uint8_t segment, unsigned short status);
+
+    // reader with device id or nullptr
+    const Reader* find(unsigned short device_id);
+
+    // join slot of reader (its place in registry, stable while it is known), -1 if reader is not known
+    int8_t position(unsigned short device_id);
+
+    // forget every reader (they join again)
+    void clear();
+
+    // reader slot (index < REGISTRY_READERS), device_id 0 if free
+    const Reader& reader(uint8_t index);
+
+    // amount of known readers
+    uint8_t size();
+
+    // heads base .. base + heads - 1 belong to one reader: frame of any of them refreshes all
+    void group(unsigned short base, uint8_t heads);
+
+    // readers silent longer than timeout die. dying 'flaps' times during 'window' ms makes reader flapping
+    void expire(uint32_t timeout, uint32_t window, uint8_t flaps);
+
+    // next reader which liveness change is not reported yet. returns false if there is none
+    bool changed(uint8_t& index);
+
+    // amount of known readers with liveness
+    uint8_t count(Liveness liveness);
+
+private:
+    // slot of reader, new slot (free or the oldest silent one) if it is not known
+    Reader& entry(unsigned short device_id, bool& known);
+
+    // frame of reader: it and other heads of reader are alive
+    void touch(Reader& reader, uint8_t segment);
+
+    Reader          _readers[REGISTRY_READERS];
+    uint32_t        _window = 0;                // start of flap window
+};
+
+#endif
@@ -0,0 +1,40 @@
+#include "ReportQueue.h"
+
+void ReportQueue::push(unsigned short device_id, unsigned long card_id, unsigned short state_id, unsigned short other_id)
+{
+    if (_size == REPORT_SLOTS)
+    {
+        pop();
+        _dropped++;
+    }
+    _reports[(_head + _size) % REPORT_SLOTS].set(device_id, card_id, state_id, other_id);
+    _size++;
+}
+
+bool ReportQueue::peek(Message& report)
+{
+    if (_size == 0)
+        return false;
+
+    report = _reports[_head];
+    return true;
+}
+
+void ReportQueue::pop()
+{
+    if (_size == 0)
+        return;
+
+    _head = (_head + 1) % REPORT_SLOTS;
+    _size--;
+}
+
+uint8_t ReportQueue::size()
+{
+    return _size;
+}
+
+uint16_t ReportQueue::dropped()
+{
+    return _dropped;
+}
@@ -0,0 +1,36 @@
+#ifndef REPORT_QUEUE_H
+#define REPORT_QUEUE_H
+
+#include <Arduino.h>
+#include "Message.h"
+
+#define REPORT_SLOTS    8                       // max reports waiting for server
+
+// decisions made by gateway itself, waiting to be journaled by server when it has time.
+// when queue is full the oldest report is dropped
+class ReportQueue
+{
+public:
+    // add report (device, card, state decided locally)
+    void push(unsigned short device_id, unsigned long card_id, unsigned short state_id, unsigned short other_id = 0);
+
+    // oldest report. returns false if queue is empty
+    bool peek(Message& report);
+
+    // remove oldest report (after it is delivered)
+    void pop();
+
+    // amount of waiting reports
+    uint8_t size();
+
+    // reports dropped because of overflow
+    uint16_t dropped();
+
+private:
+    Message         _reports[REPORT_SLOTS];
+    uint8_t         _head = 0;
+    uint8_t         _size = 0;
+    uint16_t        _dropped = 0;
+};
+
+#endif
@@ -0,0 +1,64 @@
+#include "SipHash.h"
+
+#define ROTL(x, b)      (uint64_t)(((x) << (b)) | ((x) >> (64 - (b))))
+
+uint64_t SipHash::hash(const uint8_t* key, const uint8_t* data, uint8_t length)
+{
+    uint64_t k0 = 0, k1 = 0;
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        k0 |= (uint64_t)key[i] << (8 * i);
+        k1 |= (uint64_t)key[i + 8] << (8 * i);
+    }
+    uint64_t v0 = k0 ^ 0x736f6d6570736575ULL;
+    uint64_t v1 = k1 ^ 0x646f72616e646f6dULL;
+    uint64_t v2 = k0 ^ 0x6c7967656e657261ULL;
+    uint64_t v3 = k1 ^ 0x7465646279746573ULL;
+
+    // last word has length in its high byte
+    uint8_t words = length / 8 + 1;
+    for (uint8_t w = 0; w < words; w++)
+    {
+        uint64_t m = 0;
+        for (uint8_t i = 0; i < 8 && w * 8 + i < length; i++)
+            m |= (uint64_t)data[w * 8 + i] << (8 * i);
+        if (w == words - 1)
+            m |= (uint64_t)length << 56;
+
+        v3 ^= m;
+        for (uint8_t round = 0; round < 2; round++)
+        {
+            v0 += v1; v1 = ROTL(v1, 13); v1 ^= v0; v0 = ROTL(v0, 32);
+            v2 += v3; v3 = ROTL(v3, 16); v3 ^= v2;
+            v0 += v3; v3 = ROTL(v3, 21); v3 ^= v0;
+            v2 += v1; v1 = ROTL(v1, 17); v1 ^= v2; v2 = ROTL(v2, 32);
+        }
+        v0 ^= m;
+    }
+
+    v2 ^= 0xff;
+    for (uint8_t round = 0; round < 4; round++)
+    {
+        v0 += v1; v1 = ROTL(v1, 13); v1 ^= v0; v0 = ROTL(v0, 32);
+        v2 += v3; v3 = ROTL(v3, 16); v3 ^= v2;
+        v0 += v3; v3 = ROTL(v3, 21); v3 ^= v0;
+        v2 += v1; v1 = ROTL(v1, 17); v1 ^= v2; v2 = ROTL(v2, 32);
+    }
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+void SipHash::sign(const uint8_t* key, const uint8_t* data, uint8_t length, uint8_t* tag)
+{
+    uint64_t h = hash(key, data, length);
+    for (uint8_t i = 0; i < SIPHASH_TAG; i++)
+        tag[i] = (uint8_t)(h >> (8 * i));
+}
+
+bool SipHash::verify(const uint8_t* key, const uint8_t* data, uint8_t length, const uint8_t* tag)
+{
+    uint64_t h = hash(key, data, length);
+    uint8_t diff = 0;
+    for (uint8_t i = 0; i < SIPHASH_TAG; i++)
+        diff |= tag[i] ^ (uint8_t)(h >> (8 * i));
+    return diff == 0;
+}
@@ -0,0 +1,24 @@
+#ifndef SIPHASH_H
+#define SIPHASH_H
+
+#include <Arduino.h>
+
+#define SIPHASH_KEY     16                      // bytes of shared key
+#define SIPHASH_TAG     8                       // bytes of tag
+
+// siphash-2-4 tags of udp datagrams signed with key shared by gateways and tools of site
+// (priority commands, cluster messages)
+class SipHash
+{
+public:
+    // siphash-2-4 of data with key of SIPHASH_KEY bytes
+    static uint64_t hash(const uint8_t* key, const uint8_t* data, uint8_t length);
+
+    // write tag of data (SIPHASH_TAG bytes, little-endian)
+    static void sign(const uint8_t* key, const uint8_t* data, uint8_t length, uint8_t* tag);
+
+    // tag is the one of data. compared in full, time of comparison does not tell matched bytes
+    static bool verify(const uint8_t* key, const uint8_t* data, uint8_t length, const uint8_t* tag);
+};
+
+#endif
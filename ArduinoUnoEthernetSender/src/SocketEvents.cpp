@@ -0,0 +1,59 @@
+#include "SocketEvents.h"
+#include <utility/w5100.h>
+
+#define se_mask         (e_connected | e_disconnected | e_received)
+#define se_w5100_imr    0x0016                  // interrupt mask of W5100 (bits 0-3 - sockets)
+#define se_w5500_simr   0x0018                  // socket interrupt mask of W5500 (bits 0-7 - sockets)
+
+void SocketEvents::begin(uint8_t int_pin)
+{
+    _pin = int_pin;
+    memset(_events, 0, sizeof(_events));
+
+    // INT line follows socket interrupts only where mask is known, other chips are read on every poll
+    SPI.beginTransaction(SPI_ETHERNET_SETTINGS);
+    switch (W5100.getChip())
+    {
+    case 51:
+        W5100.write(se_w5100_imr, 0x0F);
+        break;
+    case 55:
+        W5100.write(se_w5500_simr, 0xFF);       // events of every socket (Sn_IMR enables all by default)
+        break;
+    default:
+        _pin = 0;
+        break;
+    }
+    SPI.endTransaction();
+
+    if (_pin)
+        pinMode(_pin, INPUT_PULLUP);
+}
+
+void SocketEvents::poll()
+{
+    // INT is active low and stays low while any socket has event
+    if (_pin && digitalRead(_pin) == HIGH)
+        return;
+
+    SPI.beginTransaction(SPI_ETHERNET_SETTINGS);
+    for (uint8_t s = 0; s < MAX_SOCK_NUM; s++)
+    {
+        uint8_t events = W5100.readSnIR(s) & se_mask;
+        if (events)
+        {
+            _events[s] |= events;
+            W5100.writeSnIR(s, events);
+        }
+    }
+    SPI.endTransaction();
+}
+
+uint8_t SocketEvents::take(uint8_t socket)
+{
+    if (socket >= MAX_SOCK_NUM)
+        return 0;
+    uint8_t events = _events[socket];
+    _events[socket] = 0;
+    return events;
+}
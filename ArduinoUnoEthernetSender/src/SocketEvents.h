@@ -0,0 +1,35 @@
+#ifndef SOCKET_EVENTS_H
+#define SOCKET_EVENTS_H
+
+#include <Arduino.h>
+#include <Ethernet.h>
+
+// socket events of W5100/W5500 taken from socket interrupt registers. with INT line of chip wired to a pin, registers
+// are read only when chip has something to tell (line is low), so waiting for server costs no SPI traffic.
+// send events (SEND_OK, TIMEOUT) are left to Ethernet library, which waits for them itself
+class SocketEvents
+{
+public:
+    enum Event
+    {
+        e_connected     = 0x01,                 // connection established
+        e_disconnected  = 0x02,                 // peer closed connection (FIN) or it was reset
+        e_received      = 0x04                  // data received
+    };
+
+    // enable socket interrupts of chip (after Ethernet.begin). int_pin - pin wired to INT of chip
+    // (0 - not wired: registers are read on every poll)
+    void begin(uint8_t int_pin);
+
+    // collect and clear events of chip. cheap when interrupt line is not active
+    void poll();
+
+    // events of socket collected since last take
+    uint8_t take(uint8_t socket);
+
+private:
+    uint8_t         _pin = 0;
+    uint8_t         _events[MAX_SOCK_NUM];
+};
+
+#endif
@@ -0,0 +1,321 @@
+#include "TraceStream.h"
+
+void TraceStream::record(Stream* line, Print* out)
+{
+    _line = line;
+    _out = out;
+    _replay = false;
+    _length = 0;
+    _last = millis();
+}
+
+void TraceStream::replay(Stream* in, Print* out, uint8_t speed)
+{
+    _in = in;
+    _out = out;
+    _replay = true;
+    _speed = speed > 0 ? speed : 1;
+    _length = 0;
+    _position = 0;
+    _carry = 0;
+    _sent_length = 0;
+    _last = millis();
+    _started = false;
+    _parse = p_idle;
+    _out->println(F("~>"));
+}
+
+void TraceStream::frame(uint8_t bits, unsigned long code, uint8_t head)
+{
+    if (_replay)
+        return;
+
+    flushBurst();
+    uint32_t now = millis();
+    _out->print('~');
+    _out->print('w');
+    _out->print(now - _last);
+    _out->print(':');
+    _out->print(bits);
+    _out->print(':');
+    _out->print(code);
+    _out->print(':');
+    _out->println(head);
+    _last = now;
+}
+
+bool TraceStream::frame(unsigned long& code, uint8_t& head)
+{
+    if (!_replay)
+        return false;
+
+    flushSent();
+    if (!pump() || _kind != 'w')
+        return false;
+
+    code = _code;
+    head = _head;
+    next();
+    return true;
+}
+
+int TraceStream::available()
+{
+    if (_replay)
+    {
+        // frame sent since last call is complete
+        flushSent();
+
+        if (!received())
+            return 0;
+
+        // header of frame split between records would never be found: the rest waits for the next record.
+        // only when the same rest is asked for twice (Channel waits for header), inside of frame it is read
+        uint8_t pending = _length - _position;
+        if (pending <= TRACE_CARRY)
+        {
+            if (!_short)
+            {
+                _short = true;
+                return pending;
+            }
+            memmove(_burst, _burst + _position, pending);
+            next();
+            _carry = pending;
+            if (!received())
+                return 0;
+        }
+        return _length - _position;
+    }
+
+    // line is silent long enough: burst is finished
+    if (_length > 0 && millis() - _burst_time >= TRACE_GAP)
+        flushBurst();
+    return _line->available();
+}
+
+int TraceStream::read()
+{
+    if (_replay)
+    {
+        // no carrying here: Channel reads header bytes after one available() check
+        if (!received())
+            return -1;
+        uint8_t value = _burst[_position++];
+        _short = false;
+        if (_position >= _length)
+            next();
+        return value;
+    }
+
+    int value = _line->read();
+    if (value >= 0)
+        put('r', value);
+    return value;
+}
+
+int TraceStream::peek()
+{
+    if (_replay)
+        return received() ? _burst[_position] : -1;
+    return _line->peek();
+}
+
+size_t TraceStream::write(uint8_t value)
+{
+    if (_replay)
+    {
+        // transmitted bytes are only traced, there is no line
+        if (_sent_length >= TRACE_BURST)
+            flushSent();
+        _sent[_sent_length++] = value;
+        return 1;
+    }
+
+    put('t', value);
+    return _line->write(value);
+}
+
+void TraceStream::put(char kind, uint8_t value)
+{
+    if (_length > 0 && (kind != _kind || _length >= TRACE_BURST))
+        flushBurst();
+
+    if (_length == 0)
+    {
+        _kind = kind;
+        _burst_time = millis();
+    }
+    _burst[_length++] = value;
+}
+
+void TraceStream::flushBurst()
+{
+    if (_length == 0)
+        return;
+
+    printRecord(_kind, _burst_time - _last, _burst, _length);
+    _last = _burst_time;
+    _length = 0;
+}
+
+void TraceStream::flushSent()
+{
+    if (_sent_length == 0)
+        return;
+
+    uint32_t now = millis();
+    printRecord('t', now - _last, _sent, _sent_length);
+    _last = now;
+    _sent_length = 0;
+}
+
+void TraceStream::printRecord(char kind, uint32_t dt, const uint8_t* bytes, uint8_t length)
+{
+    _out->print('~');
+    _out->print(kind);
+    _out->print(dt);
+    _out->print(':');
+    for (uint8_t i = 0; i < length; i++)
+    {
+        if (bytes[i] < 0x10)
+            _out->print('0');
+        _out->print(bytes[i], HEX);
+    }
+    _out->println();
+}
+
+bool TraceStream::pump()
+{
+    while (_parse != p_ready && _in->available())
+    {
+        char c = _in->read();
+
+        // every record ends with new line
+        if (c == '\n' || c == '\r')
+        {
+            if (_parse == p_hex || _parse == p_code || _parse == p_head || (_parse == p_skip && _kind == 't'))
+            {
+                _clock += _dt;
+                if (!_started)
+                {
+                    _started = true;
+                    _start = millis();
+                    _clock = 0;
+                }
+                if (_kind == 'r')
+                    _carry = 0;                 // carried bytes are a part of this record now
+                if (_kind == 't' || (_kind == 'r' && _length == 0))
+                    next();
+                else
+                    _parse = p_ready;
+            }
+            else if (_parse != p_idle)
+            {
+                _parse = p_idle;
+                _out->println(F("~>"));
+            }
+            continue;
+        }
+
+        switch (_parse)
+        {
+        case p_idle:
+        {
+            if (c == '~')
+                _parse = p_kind;
+            break;
+        }
+        case p_kind:
+        {
+            _kind = c;
+            _dt = 0;
+            _length = _carry;
+            _position = 0;
+            _nibble = -1;
+            _bits = 0;
+            _code = 0;
+            _head = 0;
+            _parse = (c == 'r' || c == 't' || c == 'w') ? p_dt : p_skip;
+            break;
+        }
+        case p_dt:
+        {
+            if (c >= '0' && c <= '9')
+                _dt = _dt * 10 + (c - '0');
+            else if (c == ':')
+                _parse = _kind == 'r' ? p_hex : (_kind == 'w' ? p_bits : p_skip);
+            else
+                _parse = p_skip;
+            break;
+        }
+        case p_hex:
+        {
+            int8_t v = -1;
+            if (c >= '0' && c <= '9')
+                v = c - '0';
+            else if (c >= 'A' && c <= 'F')
+                v = c - 'A' + 10;
+            else if (c >= 'a' && c <= 'f')
+                v = c - 'a' + 10;
+
+            if (v < 0 || _length >= sizeof(_burst))
+                break;
+            if (_nibble < 0)
+            {
+                _nibble = v;
+            }
+            else
+            {
+                _burst[_length++] = (_nibble << 4) | v;
+                _nibble = -1;
+            }
+            break;
+        }
+        case p_bits:
+        {
+            if (c >= '0' && c <= '9')
+                _bits = _bits * 10 + (c - '0');
+            else if (c == ':')
+                _parse = p_code;
+            break;
+        }
+        case p_code:
+        {
+            if (c >= '0' && c <= '9')
+                _code = _code * 10 + (c - '0');
+            else if (c == ':')
+                _parse = p_head;
+            break;
+        }
+        case p_head:
+        {
+            if (c >= '0' && c <= '9')
+                _head = _head * 10 + (c - '0');
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    if (_parse != p_ready)
+        return false;
+
+    // record is due when it's trace time (scaled by speed) passed since replay start
+    return millis() - _start >= _clock / _speed;
+}
+
+bool TraceStream::received()
+{
+    return pump() && _kind == 'r';
+}
+
+void TraceStream::next()
+{
+    _parse = p_idle;
+    _length = 0;
+    _position = 0;
+    _short = false;
+    _out->println(F("~>"));
+}
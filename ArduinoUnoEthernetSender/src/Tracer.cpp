@@ -0,0 +1,85 @@
+#include "Tracer.h"
+
+#define tracer_id_mask  0x7FFF                  // own ids are 1..32767 with own bit
+
+void Tracer::begin(Print* out, uint16_t own)
+{
+    _out = out;
+    _own = own;
+    memset(_open, 0, sizeof(_open));
+}
+
+uint16_t Tracer::open(unsigned short device_id, uint16_t trace)
+{
+    if (trace == 0)
+    {
+        _next = (_next + 1) & tracer_id_mask;
+        if (_next == 0)
+            _next = 1;
+        trace = _next | _own;
+    }
+
+    Open* open = slot(device_id);
+    for (uint8_t i = 0; i < TRACER_OPEN && !open; i++)
+    {
+        if (_open[i].trace == 0)
+            open = &_open[i];
+    }
+    if (!open)
+    {
+        open = &_open[_replace];
+        _replace = (_replace + 1) % TRACER_OPEN;
+    }
+
+    open->device_id = device_id;
+    open->trace = trace;
+    return trace;
+}
+
+uint16_t Tracer::find(unsigned short device_id)
+{
+    Open* open = slot(device_id);
+    return open ? open->trace : 0;
+}
+
+void Tracer::stage(unsigned short device_id, const __FlashStringHelper* name)
+{
+    Open* open = slot(device_id);
+    if (!open)
+        return;
+    line(*open, name);
+    _out->println();
+}
+
+void Tracer::close(unsigned short device_id, const __FlashStringHelper* name, unsigned short state_id)
+{
+    Open* open = slot(device_id);
+    if (!open)
+        return;
+    line(*open, name);
+    _out->print(':');
+    _out->println(state_id);
+    open->trace = 0;
+}
+
+Tracer::Open* Tracer::slot(unsigned short device_id)
+{
+    for (uint8_t i = 0; i < TRACER_OPEN; i++)
+    {
+        if (_open[i].trace != 0 && _open[i].device_id == device_id)
+            return &_open[i];
+    }
+    return nullptr;
+}
+
+void Tracer::line(const Open& open, const __FlashStringHelper* name)
+{
+    _out->print('$');
+    _out->print(name);
+    _out->print(':');
+    _out->print(open.device_id);
+    _out->print(':');
+    _out->print(open.trace);
+    _out->print(':');
+    _out->print(micros());
+}
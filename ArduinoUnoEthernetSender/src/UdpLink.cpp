@@ -0,0 +1,181 @@
+#include "UdpLink.h"
+
+#define udp_rto_initial 200                     // timeout before first rtt sample
+#define udp_rto_min     20                      // min retransmission timeout
+#define udp_rto_max     400                     // max retransmission timeout
+#define udp_attempts    4                       // transmissions of one request before giving up
+#define udp_deadline    600                     // max time of one request (reader still has time for http fallback)
+
+bool UdpLink::begin(const char* host, uint16_t port, uint16_t local_port)
+{
+    _port = port;
+    _ready = false;
+    for (uint8_t i = 0; i < UDP_PENDING; i++)
+        _pending[i].active = false;
+
+    _udp.stop();
+    if (!_udp.begin(local_port))
+        return false;
+
+    DNSClient dns;
+    dns.begin(Ethernet.dnsServerIP());
+    _ready = dns.getHostByName(host, _server) == 1;
+
+    // request ids are not guessable: forged reply has to come from server address and port and carry id of request.
+    // time of start depends on DHCP and DNS exchanges
+    randomSeed(micros());
+    return _ready;
+}
+
+bool UdpLink::request(unsigned short device_id, unsigned long card_id, uint8_t tag)
+{
+    if (!_ready)
+        return false;
+
+    for (uint8_t i = 0; i < UDP_PENDING; i++)
+    {
+        Pending& p = _pending[i];
+        if (p.active)
+            continue;
+
+        p.request_id = nextId();
+        p.active = true;
+        p.device_id = device_id;
+        p.card_id = card_id;
+        p.tag = tag;
+        p.attempts = 0;
+        p.timeout = rto();
+        p.started = millis();
+        transmit(p);
+        return true;
+    }
+    return false;
+}
+
+bool UdpLink::update(Result& result)
+{
+    // replies
+    while (_udp.parsePacket() > 0)
+    {
+        Datagram reply;
+        int length = _udp.read((unsigned char*)&reply, sizeof(reply));
+        if (length != sizeof(reply) || reply.magic != UDP_MAGIC || reply.type != t_lookup)
+            continue;
+        if (_udp.remoteIP() != _server || _udp.remotePort() != _port)
+            continue;
+
+        for (uint8_t i = 0; i < UDP_PENDING; i++)
+        {
+            Pending& p = _pending[i];
+            if (!p.active || p.request_id != reply.request_id || p.card_id != reply.card_id)
+                continue;
+
+            // karn's algorithm: retransmitted request gives ambiguous rtt
+            if (p.attempts == 1)
+                sample(millis() - p.sent);
+
+            // decision is for device and card of request, whatever else reply says
+            p.active = false;
+            result.device_id = p.device_id;
+            result.card_id = p.card_id;
+            result.state_id = reply.state_id;
+            result.tag = p.tag;
+            result.elapsed = millis() - p.started;
+            result.timeout = false;
+            return true;
+        }
+    }
+
+    // retransmissions
+    uint32_t now = millis();
+    for (uint8_t i = 0; i < UDP_PENDING; i++)
+    {
+        Pending& p = _pending[i];
+        if (!p.active || now - p.sent < p.timeout)
+            continue;
+
+        if (p.attempts >= udp_attempts || now - p.started >= udp_deadline)
+        {
+            p.active = false;
+            result.device_id = p.device_id;
+            result.card_id = p.card_id;
+            result.state_id = 0;
+            result.tag = p.tag;
+            result.elapsed = now - p.started;
+            result.timeout = true;
+            return true;
+        }
+
+        p.timeout = min(p.timeout * 2, udp_rto_max);
+        transmit(p);
+    }
+
+    return false;
+}
+
+uint8_t UdpLink::pending()
+{
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < UDP_PENDING; i++)
+    {
+        if (_pending[i].active)
+            count++;
+    }
+    return count;
+}
+
+uint16_t UdpLink::nextId()
+{
+    while (true)
+    {
+        uint16_t id = random(1, 0x10000);
+        bool used = false;
+        for (uint8_t i = 0; i < UDP_PENDING; i++)
+            used |= _pending[i].active && _pending[i].request_id == id;
+        if (!used)
+            return id;
+    }
+}
+
+void UdpLink::transmit(Pending& p)
+{
+    Datagram request;
+    request.magic = UDP_MAGIC;
+    request.type = t_lookup;
+    request.request_id = p.request_id;
+    request.device_id = p.device_id;
+    request.card_id = p.card_id;
+    request.state_id = 0;
+    request.other_id = 0;
+
+    _udp.beginPacket(_server, _port);
+    _udp.write((const uint8_t*)&request, sizeof(request));
+    _udp.endPacket();
+
+    p.sent = millis();
+    p.attempts++;
+}
+
+void UdpLink::sample(uint16_t rtt)
+{
+    if (_srtt < 0)
+    {
+        _srtt = rtt;
+        _rttvar = rtt / 2;
+        return;
+    }
+
+    // rfc 6298: rttvar = 3/4 rttvar + 1/4 |srtt - rtt|, srtt = 7/8 srtt + 1/8 rtt
+    int16_t delta = _srtt - (int16_t)rtt;
+    if (delta < 0)
+        delta = -delta;
+    _rttvar += (delta - _rttvar) / 4;
+    _srtt += ((int16_t)rtt - _srtt) / 8;
+}
+
+uint16_t UdpLink::rto()
+{
+    if (_srtt < 0)
+        return udp_rto_initial;
+    return constrain(_srtt + 4 * _rttvar, udp_rto_min, udp_rto_max);
+}
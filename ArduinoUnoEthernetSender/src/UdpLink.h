@@ -0,0 +1,93 @@
+#ifndef UDP_LINK_H
+#define UDP_LINK_H
+
+#include <Arduino.h>
+#include <Dns.h>
+#include <Ethernet.h>
+#include <EthernetUdp.h>
+
+#define UDP_MAGIC       0x53                    // first byte of every datagram
+#define UDP_PENDING     4                       // max requests waiting for reply at once
+
+// compact request/response protocol with server: one datagram per request, one per reply.
+// lost datagrams are retransmitted with adaptive timeout (smoothed rtt + 4 * rtt variance, doubled for every retry)
+class UdpLink
+{
+public:
+    // datagram layout (little-endian, no padding), the same for request and reply
+    struct Datagram
+    {
+        uint8_t         magic;                  // UDP_MAGIC
+        uint8_t         type;                   // t_lookup
+        uint16_t        request_id;             // random, reply carries id of request
+        unsigned short  device_id;
+        unsigned long   card_id;
+        unsigned short  state_id;               // request: 0; reply: server state
+        unsigned short  other_id;               // reserved (0)
+    };
+
+    enum Type
+    {
+        t_lookup        = 1                     // card lookup (the same as GET baseadd2.php?id=&kod=)
+    };
+
+    // finished request
+    struct Result
+    {
+        unsigned short  device_id;
+        unsigned long   card_id;
+        unsigned short  state_id;
+        uint8_t         tag;                    // tag given to request()
+        uint16_t        elapsed;                // ms since request()
+        bool            timeout;                // true if no reply after all retries
+    };
+
+    // open local socket and resolve server host. returns false if host was not resolved
+    bool begin(const char* host, uint16_t port, uint16_t local_port);
+
+    // send lookup request. tag is not sent, it is returned with result (e.g. bus segment of reader).
+    // returns false if too many requests are waiting for reply
+    bool request(unsigned short device_id, unsigned long card_id, uint8_t tag = 0);
+
+    // receive replies and retransmit lost requests. returns true if request is finished (call again while true)
+    bool update(Result& result);
+
+    // amount of requests waiting for reply
+    uint8_t pending();
+
+private:
+    struct Pending
+    {
+        bool            active;
+        uint16_t        request_id;
+        unsigned short  device_id;
+        unsigned long   card_id;
+        uint8_t         tag;
+        uint32_t        started;                // time of first transmission
+        uint32_t        sent;                   // time of last transmission
+        uint16_t        timeout;                // current retransmission timeout
+        uint8_t         attempts;
+    };
+
+    // random request id, not taken by waiting request
+    uint16_t nextId();
+
+    // send request datagram of pending request
+    void transmit(Pending& p);
+
+    // update rtt estimation with new sample (only from requests which were not retransmitted)
+    void sample(uint16_t rtt);
+
+    // current retransmission timeout
+    uint16_t rto();
+
+    EthernetUDP     _udp;
+    IPAddress       _server;
+    uint16_t        _port = 0;
+    bool            _ready = false;
+    Pending         _pending[UDP_PENDING];
+    int16_t         _srtt = -1;                 // smoothed rtt, ms (-1 - no samples yet)
+    int16_t         _rttvar = 0;                // rtt variance, ms
+};
+
+#endif
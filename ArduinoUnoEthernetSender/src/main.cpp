@@ -8,13 +8,95 @@
 #include <Arduino.h>
 #include <ArduinoJson.hpp>
 #include <ArduinoJson.h>
+#include <AllowSet.h>
+#include <Admission.h>
+#include <Backends.h>
+#include <HttpRequest.h>
+#include <DnsCache.h>
+#include <SocketEvents.h>
+#include <ReaderRegistry.h>
+#include <PriorityBroadcast.h>
+#include <Tracer.h>
+#include <Benchmark.h>
+#include <CardIndex.h>
+#include <Channel.h>
+#include <Cluster.h>
+#include <Coalescer.h>
+#include <DecisionCache.h>
 #include <Ethernet.h>
-#include <EasyTransfer.h>
 #include <Message.h>
+#include <PresenceTable.h>
+#include <Profiler.h>
+#include <ReportQueue.h>
 #include <SoftwareSerial.h>
 #include <SPI.h>
+#include <Timer.h>
+#include <TraceStream.h>
+#include <UdpLink.h>
 
 #define DEBUG true
+#define PROFILE false                           // measure cycles of hot paths and print statistics to serial
+#define BENCHMARK false                         // run benchmarks of protocol and server response paths on start
+#define TRACE_RECORD false                      // write bus bytes to serial as trace
+#define TRACE_REPLAY false                      // take bus bytes from trace coming to serial
+#define TRACE_IDS false                         // print stage timestamps of card transactions, pass trace id to server
+#define UDP_TRANSPORT false                     // request server via compact udp protocol (http is fallback)
+#define HW_SEGMENT false                        // second RS485 segment on hardware serial (pins 0, 1)
+#define DECISION_CACHE false                    // answer repeated denials without server
+#define CLUSTER false                           // share decision cache with other gateways via udp multicast
+#define PRESENCE false                          // local anti-passback by direction of readers
+#define COALESCE false                          // one lookup for swipes of the same card at once
+#define OPTIMISTIC false                        // allow recently allowed cards before server answer
+#define BLOCK_FILTER false                      // push blocked and invalid cards to filters of readers
+#define CARD_INDEX false                        // allow cards of flash index when server is not available
+#define ADMISSION false                         // answer "busy" at once when lookup would not fit into reader timeout
+#define BACKENDS false                          // several servers: fastest healthy one, failover and hedged requests
+#define DNS_CACHE false                         // resolve server hosts in background, connect by cached address
+#define ETH_EVENTS false                        // wait for server answer by socket events of ethernet chip, serve buses meanwhile
+#define READER_REGISTRY false                   // registration, heartbeat and status of readers handled by gateway, not server
+#define PRIORITY false                          // site-wide commands to readers, repeated until every registered reader acknowledges
+#define LIVENESS false                          // readers silent for long are dead, changes (and flapping) go to journal
+#define DOOR_EVENTS false                       // door events of readers (forced, held open, exit, tamper) go to journal
+
+#define LOCAL_REPORTS (PRESENCE || OPTIMISTIC || BLOCK_FILTER || CARD_INDEX || READER_REGISTRY || DOOR_EVENTS)  // journaled later
+
+#if CLUSTER && !DECISION_CACHE
+#error "CLUSTER shares DECISION_CACHE: switch it on"
+#endif
+
+
+#if ETH_EVENTS && BACKENDS
+#error "BACKENDS waits for hedged answers itself: switch off ETH_EVENTS"
+#endif
+
+#if PRIORITY && !READER_REGISTRY
+#error "PRIORITY waits for acknowledgements of registered readers: switch on READER_REGISTRY"
+#endif
+
+// keys are per site, never in sources: build_flags = -D CLUSTER_SITE_KEY=0x..,0x..,... (16 bytes) in platformio.ini
+#if CLUSTER && !defined(CLUSTER_SITE_KEY)
+#error "CLUSTER messages are signed with key of site: define CLUSTER_SITE_KEY (16 bytes) in build_flags"
+#endif
+
+#if PRIORITY && !defined(PRIORITY_SITE_KEY)
+#error "PRIORITY commands are signed with key of site: define PRIORITY_SITE_KEY (16 bytes) in build_flags"
+#endif
+
+#if LIVENESS && !READER_REGISTRY
+#error "LIVENESS is kept in reader registry: switch on READER_REGISTRY"
+#endif
+
+// sockets held at once: TCP client, DNS (cache or query of connect), hedge client, udp lookups, cluster, priority commands.
+// ethernet library of Uno has 4 of them (W5100 and W5500 alike)
+#define ETH_SOCKETS (2 + BACKENDS + UDP_TRANSPORT + CLUSTER + PRIORITY)
+
+#if ETH_SOCKETS > 4
+#error "4 sockets of ethernet chip: switch off one of BACKENDS, UDP_TRANSPORT, CLUSTER, PRIORITY"
+#endif
+
+#if HW_SEGMENT && (DEBUG || PROFILE || BENCHMARK || TRACE_RECORD || TRACE_REPLAY || TRACE_IDS)
+#error "HW_SEGMENT takes hardware serial: switch off DEBUG, PROFILE, BENCHMARK and TRACE_*"
+#endif
 
 #if DEBUG
 
@@ -42,8 +124,6 @@ char debug_buffer[64];
 #define         broadcast_id    999             // id for receiving broadcast messages (for all devices)
 
 void(* resetBoard) (void)       = 0;            // reset Arduino Uno function
-EasyTransfer    easy_transfer;                  // RS485 message exchanger
-Message         message;                        // exchangeable object
 
 #pragma endregion //GLOBAL_SETTINGS
 
@@ -51,20 +131,56 @@ Message         message;                        // exchangeable object
 
 #define         rs_rx_pin       2               // receive pin
 #define         rs_tx_pin       3               // transmit pin
-#define         rs_pwr_pin      9               // power (5v) pin
+#define         rs_pwr_pin      9               // power (5v) pin (of all segments)
 #define         rs_baud         9600            // baud speed
 SoftwareSerial  rs485(rs_rx_pin, rs_tx_pin);    // custom rx\tx serial
 
+// independent RS485 bus: own stream, frame channel (static rx buffers and state) and frame being handled
+struct Segment
+{
+    Stream*         stream;
+    Channel<Message> channel;
+    const Message*  message;                    // received frame (in channel buffer), copied by requestServer()
+};
+
+#if HW_SEGMENT
+#define         rs_segments     2               // 0 - software serial rs485, 1 - hardware serial
+#else
+#define         rs_segments     1               // software serial rs485 only
+#endif //HW_SEGMENT
+
+Segment         segments[rs_segments];          // buses served in turn
+Segment*        segment = segments;             // bus of message being handled
+Message         lookup;                         // lookup made again without frame (udp fallback, waiting lookup)
+
 #pragma endregion //V_RS485
 
 #pragma region V_ETHERNET
 
 #define         reconnect_delay 1000            // delay for try to reconnect ethernet
+#define         dns_local_port  8587            // local port of dns queries
 EthernetClient  client;                         // object for connecting server as client
 byte            mac[] = { 0x54, 0x34, 
                           0x41, 0x30, 
                           0x30, 0x35 };
 
+
+#if DNS_CACHE
+DnsCache        dns_cache;                      // addresses of server hosts
+#endif //DNS_CACHE
+
+#define         eth_int_pin     8               // pin wired to INT of W5x00 by hand, not by shield jumper (it takes D2 - rs_rx_pin). 0 - not wired, socket registers are read every loop
+#define         eth_answer      1200            // max wait (ms) for server answer
+
+#if ETH_EVENTS
+SocketEvents    eth_events;                     // connected, received and closed events of sockets
+bool            http_busy = false;              // lookup in client waits for server answer
+Message         http_message;                   // request of that lookup
+Segment*        http_segment = nullptr;         // bus of reader waiting for it
+uint32_t        http_sent = 0;                  // time of request
+ReportQueue     http_waiting;                   // lookups waiting for client (other_id - segment)
+#endif //ETH_EVENTS
+
 #pragma endregion //V_ETHERNET
 
 #pragma region V_SERVER
@@ -72,10 +188,248 @@ byte            mac[] = { 0x54, 0x34,
 #define         srvr_port   80                  // default HTTP server port
 #define         srvr_name   "skdmk.fd.mk.ua"
 #define         srvr_rqst   "GET /skd.mk/baseadd2.php?"
+#define         srvr_jrnl   "GET /skd.mk/journal.php?"  // journal reports (never taken for lookups), answer is json of lookup
 #define         srvr_rcv    500                 // time for waiting response from server
+#define         srvr_udp_port   8585            // server port of udp protocol
+#define         udp_local_port  8585            // local port of udp protocol
+
+#define         co_window       1500            // time (ms) lookup result is given to new swipes of the same card
+#define         adm_budget      1000            // time (ms) reader may wait for answer (it gives up after 1500)
+
+#if UDP_TRANSPORT
+UdpLink         udp_link;                       // udp requests to server with retransmissions
+#endif //UDP_TRANSPORT
+
+#if COALESCE
+Coalescer       flights;                        // lookups in flight and their waiting readers
+#endif //COALESCE
+
+#if ADMISSION
+Admission       admission;                      // server latency and lookups admission
+#endif //ADMISSION
 
 #pragma endregion //V_SERVER
 
+#pragma region V_BACKENDS
+
+#define         bk_connect      250             // connection timeout (ms) of one server
+#define         bk_answer       1200            // max wait (ms) for answer of server (of all servers when hedged)
+#define         bk_hedge_min    150             // min wait (ms) for answer before the same request goes to another server
+#define         bk_hedge_max    600             // max wait (ms) for answer before the same request goes to another server
+#define         bk_check_period 1000            // pause between health checks of servers which are down
+
+#if BACKENDS
+const Backends::Endpoint srvr_endpoints[] = {   // servers with the same database
+    { srvr_name, srvr_port },
+    // { "192.168.1.10", 8080 },                // e.g. local mock server (tools/mock_server.py)
+};
+
+Backends        backends;                       // latency and health of servers
+EthernetClient  hedge_client;                   // the same request to another server
+int8_t          srvr_current = -1;              // server of request in client
+uint32_t        srvr_sent = 0;                  // time of request in client
+Timer           bk_timer;                       // health checks timer
+#endif //BACKENDS
+
+#pragma endregion //V_BACKENDS
+
+#pragma region V_CACHE
+
+#define         cache_ttl_card  300             // seconds to remember unknown or blocked card (for any device)
+#define         cache_ttl_denied 60             // seconds to remember denial on device
+#define         cl_group        239, 1, 85, 85  // multicast group of site gateways
+#define         cl_port         8586            // port of cluster messages
+#define         cl_accepted     ((1 << st_denied) | (1 << st_invalid) | (1 << st_blocked))  // decisions taken from peers
+
+#if DECISION_CACHE
+DecisionCache   cache;                          // recent server decisions
+#endif //DECISION_CACHE
+
+#if CLUSTER
+const uint8_t   cl_key[SIPHASH_KEY] = { CLUSTER_SITE_KEY };  // the same on every gateway and in tools/cluster_peer.py
+Cluster         cluster;                        // decisions exchange with other gateways
+#endif //CLUSTER
+
+#pragma endregion //V_CACHE
+
+#pragma region V_PRESENCE
+
+#define         pr_forget       960             // minutes after which presence of card is unknown (missed exit)
+#define         rp_period       200             // pause between delivering reports to server
+
+// direction of reader (readers which are not listed have no anti-passback)
+struct ReaderDirection
+{
+    unsigned short  device_id;
+    uint8_t         direction;                  // PresenceTable::Direction
+};
+
+// site configuration: entrance and exit readers
+const ReaderDirection pr_readers[] PROGMEM = {
+    { 1, PresenceTable::d_in  },
+    { 2, PresenceTable::d_out }
+};
+
+#if PRESENCE
+PresenceTable   presence;                       // last passage of cards
+#endif //PRESENCE
+
+#if OPTIMISTIC
+AllowSet        allowed;                        // cards recently allowed on readers
+#endif //OPTIMISTIC
+
+#if LOCAL_REPORTS
+ReportQueue     reports;                        // local decisions for server journal
+Timer           rp_timer;                       // reports delivering timer
+#endif //LOCAL_REPORTS
+
+#pragma endregion //V_PRESENCE
+
+#pragma region V_REGISTRY
+
+#define         rg_slot_time    50              // ms of one join slot of readers (frame and acknowledgement at 9600 baud)
+
+#define         lv_check        1000            // period of liveness check
+#define         lv_dead         16000           // reader is dead after this silence (3 idle heartbeats of reader and margin)
+#define         lv_flap_window  600000          // window of flapping detection (10 minutes)
+#define         lv_flaps        3               // deaths during window which make reader flapping
+
+#if READER_REGISTRY
+ReaderRegistry  registry;                       // reader heads of all segments
+#endif //READER_REGISTRY
+
+#if LIVENESS
+Timer           lv_timer;                       // liveness check timer
+#endif //LIVENESS
+
+#pragma endregion //V_REGISTRY
+
+#pragma region V_PRIORITY
+
+#define         pb_port         8588            // udp port of priority commands (tools/priority_command.py)
+#define         pb_ack_slot     20              // ms of acknowledgement slot of one reader (frame at 9600 baud and turnaround)
+#define         pb_repeat       400             // ms between repeats of command frame (acknowledgement slots of 16 readers)
+#define         pb_tries        5               // max command frames before fan-out is given up
+#define         pb_admin        0, 0, 0, 0      // the only host commands are taken from (0, 0, 0, 0 - any host with key)
+#define         pb_nonce_address 0              // EEPROM address of nonce of last accepted command
+
+#if PRIORITY
+const uint8_t   pb_key[SIPHASH_KEY] = { PRIORITY_SITE_KEY };  // the same as key of tools/priority_command.py
+PriorityBroadcast priority;                     // command being delivered to readers
+uint8_t         pb_mode = 0;                    // pc_normal, pc_unlock_all or pc_lockdown
+#endif //PRIORITY
+
+#pragma endregion //V_PRIORITY
+
+#pragma region V_DOOR_EVENTS
+
+#define         dr_readers      8               // readers whose last journaled door event is remembered
+
+#if DOOR_EVENTS
+// last journaled door event of reader: repeats (lost acknowledgement) are acknowledged again, not journaled
+struct DoorEvent
+{
+    unsigned short  device_id;
+    unsigned long   card_id;                    // reader millis() of edge
+    uint8_t         event;
+};
+DoorEvent       dr_last[dr_readers];
+uint8_t         dr_next = 0;                    // slot taken by reader not remembered yet (round robin)
+#endif //DOOR_EVENTS
+
+#pragma endregion //V_DOOR_EVENTS
+
+#pragma region V_CARD_INDEX
+
+#define         ci_flash_cs     7               // chip select pin of SPI flash with index (0 - index in PROGMEM)
+#define         ci_slot_size    0x80000UL       // bytes of one image slot of SPI flash (A - 0, B - ci_slot_size)
+
+#if CARD_INDEX
+CardIndex       card_index;                     // cards exported from server (tools/card_index.py)
+bool            eth_offline     = false;        // link is lost, lookups are answered by index (readers got er_no_ethr_cnctn 2)
+#endif //CARD_INDEX
+
+#if CARD_INDEX && ci_flash_cs == 0
+#include <CardIndexData.h>
+#endif //CARD_INDEX && ci_flash_cs == 0
+
+#pragma endregion //V_CARD_INDEX
+
+#pragma region V_PROFILER
+
+#if PROFILE
+
+#define         prof_period     10000           // statistics printing period
+#define         prof_tolerance  10              // allowed slowdown relative to baseline (%)
+
+// measured code paths
+enum ProfileSlot
+{
+    p_et_send,
+    p_et_receive,
+    p_send_server,
+    p_receive_server,
+    p_json_parse,
+    p_count
+};
+
+const char      p_name_0[] PROGMEM = "Channel::send";
+const char      p_name_1[] PROGMEM = "Channel::receive";
+const char      p_name_2[] PROGMEM = "sendServer";
+const char      p_name_3[] PROGMEM = "receiveServer";
+const char      p_name_4[] PROGMEM = "receiveServer json";
+const char* const prof_names[p_count] PROGMEM = { p_name_0, p_name_1, p_name_2, p_name_3, p_name_4 };
+
+// mean cycles of reference build (0 - not measured yet), avg of 'prof' lines printed by board (simavr has no W5100 model)
+const uint32_t  prof_baselines[p_count] PROGMEM = { 0, 0, 0, 0, 0 };
+
+Profiler        profiler;                       // cycle counter of hot paths
+Timer           prof_timer;                     // statistics printing timer
+
+#define profile_start(slot) profiler.start(slot)
+#define profile_stop(slot)  profiler.stop(slot)
+
+#else
+
+#define profile_start(slot)
+#define profile_stop(slot)
+
+#endif //PROFILE
+
+#if PROFILE || BENCHMARK
+
+// Timer1 overflows of cycle counter (without profiler Timer1 and its vector stay free for other code)
+ISR(TIMER1_OVF_vect)
+{
+    Profiler::overflow();
+}
+
+#endif //PROFILE || BENCHMARK
+
+#pragma endregion //V_PROFILER
+
+#pragma region V_TRACE
+
+#if TRACE_RECORD || TRACE_REPLAY
+
+#define         trace_speed     1               // replay speed multiplier (1 - original timing)
+TraceStream     trace;                          // recorder/player of bus traffic between Channel and RS485
+#define         bus_stream      trace
+
+#else
+
+#define         bus_stream      rs485
+
+#endif //TRACE_RECORD || TRACE_REPLAY
+
+#define         tr_own_ids      0x8000          // bit of trace ids given by gateway (reader did not give one)
+
+#if TRACE_IDS
+Tracer          tracer;                         // stages of card transactions
+#endif //TRACE_IDS
+
+#pragma endregion //V_TRACE
+
 #pragma region SERVER_STATES
                                                 
 // responses:
@@ -85,6 +439,7 @@ byte            mac[] = { 0x54, 0x34,
 #define st_denied           3                   // access denied
 #define st_invalid          4                   // invalid card (database does not contain such card)
 #define st_blocked          5                   // card is blocked
+#define st_busy             6                   // gateway is overloaded, retry after other_id ms
 
 // errors:
 #define er_no_srvr_cnctn    95                  // no server connection             | !client.connect(server, port)
@@ -94,6 +449,44 @@ byte            mac[] = { 0x54, 0x34,
 #define er_timeout          99                  // server connection timeout        | !client.available()
 #define er_no_ethr_cnctn    100                 // no ethernet connection           | !ethernetConnected()
 
+// journal (reports of gateway, not sent to readers):
+#define jr_unconfirmed      90                  // optimistic grant is not confirmed by server (other - server state)
+#define jr_offline_allow    91                  // card allowed by index without server (other - server error)
+#define jr_registered       92                  // reader (re)started (other - bus segment)
+#define jr_status           93                  // reader status changed (other - status)
+#define jr_liveness         94                  // reader liveness changed (other - 0 alive, 1 dead, 2 flapping)
+
+// control (not responses, no signals). frames of reader with these states are never card lookups:
+#define ct_first            110                 // first state of control range
+#define ct_last             127                 // last state of control range
+#define ct_filter_add       110                 // add card to blocked cards filter of readers
+#define ct_filter_remove    111                 // remove card from blocked cards filter
+#define ct_filter_clear     112                 // clear blocked cards filter
+#define ct_filter_hit       113                 // card rejected by filter (reader report for journal)
+#define ct_register         114                 // reader started (readers before it send card 0 lookup)
+#define ct_ack              115                 // gateway got control frame (other - its state). from reader: priority
+                                                // command applied (card - sequence, other - heads of reader)
+#define ct_heartbeat        116                 // reader is alive (other - heads of reader, 0 - unknown)
+#define ct_status           117                 // reader status (other - status)
+#define ct_resync           118                 // every reader joins again in slot order (other - slot time, ms)
+#define ct_priority         119                 // site-wide command, goes before other frames (card - sequence, other - command)
+#define ct_door             120                 // door event of reader for journal (card - reader millis() of edge, other - event)
+
+// priority commands (other of ct_priority):
+#define pc_normal           0                   // end of unlock or lockdown
+#define pc_unlock_all       1                   // emergency: every door is open until pc_normal
+#define pc_lockdown         2                   // nobody passes until pc_normal, cards are not looked up
+#define pc_cache_flush      3                   // forget cached decisions and filters
+
+// door events (other of ct_door), journaled as they are:
+#define dr_closed           0                   // door closed
+#define dr_opened           1                   // door opened after access allowed or exit button
+#define dr_forced           2                   // door opened without access
+#define dr_held             3                   // door opened with access stays open too long
+#define dr_exit             4                   // exit button pressed
+#define dr_tamper           5                   // case of reader opened
+#define dr_tamper_closed    6                   // case of reader closed again
+
 #pragma endregion //SERVER_STATES
 
 #pragma region F_DECLARATION
@@ -104,17 +497,69 @@ bool ethernetConnected();
 // recursive function for establishing DHCP connection
 void ethernetConnect();
 
-// send data to server
-void sendServer();
+// request card state from server (udp if enabled and possible, otherwise http)
+void requestServer();
+
+// connect server by cached address (by host name if it is not resolved)
+bool connectServer(EthernetClient& http, const char* host, uint16_t port);
+
+// handle frame which is not card lookup (reader control, reports). returns false for card lookup
+bool handleControl();
+
+// http lookup of request: at once, or started and finished by finishLookup() with ETH_EVENTS
+void lookupServer(const Message& message);
+
+// take server answer when socket of lookup got data or was closed (or give up after eth_answer), start next waiting lookup
+void finishLookup();
+
+// send request to server. returns false if request failed (reader is already answered)
+bool sendServer(const Message& message);
+
+// write lookup request to connected server by one write (hedge - the same request was sent to other server)
+void printLookup(EthernetClient& http, const char* host, const Message& message, bool hedge = false);
+
+// wait for the first answer of servers (hedged request is sent when server is slow). returns client with answer
+// after headers, or client without data if nobody answered
+EthernetClient& waitServers(const Message& message);
+
+// try to connect server which is down
+void checkServers();
+
+// receive response from server to request
+void receiveServer(const Message& message);
+
+// parse server json response ({"id":"..","kod":"..","status":..}) to message
+DeserializationError parseResponse(Stream& stream, Message& response);
+
+// send lookup result to reader and to readers waiting for the same card
+void answerLookup(unsigned short device_id, unsigned long card_id, unsigned short state_id);
+
+// remember server decision in cache and share it with other gateways
+void rememberDecision(unsigned short device_id, unsigned long card_id, unsigned short state_id);
+
+// direction of reader from site configuration
+uint8_t readerDirection(unsigned short device_id);
+
+// deliver oldest local decision to server journal
+void reportServer();
+
+// read card index image from SPI flash or PROGMEM
+void readCardIndex(uint32_t address, void* buffer, uint16_t length);
 
-// receive response from server
-void receiveServer();
+// amount of reader frames waiting in buffers of all segments
+uint8_t queuedLookups();
 
-// send message to slave
+// send message to slave on current segment
 void sendData(unsigned short device_id, unsigned long card_id, unsigned short state_id, unsigned short other_id);
 
-// send broadcast message (for all of devices connected by RS485)
-void sendBroadcast(unsigned short state_id, unsigned short other_id);
+// send broadcast message (for all of devices connected by RS485, on every segment)
+void sendBroadcast(unsigned short state_id, unsigned short other_id, unsigned long card_id = 0);
+
+// apply priority command on gateway and start its fan-out to every registered reader
+void startPriority(uint8_t command);
+
+// remember door event as the last one of its reader. returns false if it is a repeat of the last one
+bool newDoorEvent(const Message& message);
 
 #pragma endregion //F_DECLARATION
 
@@ -123,7 +568,15 @@ void setup()
     pinMode(rs_pwr_pin, OUTPUT);
     digitalWrite(rs_pwr_pin, HIGH);
     rs485.begin(rs_baud);
-    easy_transfer.begin(details(message), &rs485);
+    segments[0].stream = &bus_stream;
+    #if HW_SEGMENT
+    Serial.begin(rs_baud);
+    segments[1].stream = &Serial;
+    #endif //HW_SEGMENT
+    for (uint8_t i = 0; i < rs_segments; i++)
+    {
+        segments[i].channel.begin(segments[i].stream);
+    }
     SPI.begin();
 
     #if DEBUG
@@ -137,24 +590,304 @@ void setup()
     debugln_s("\t\t---");
     #endif //DEBUG
 
+    #if (PROFILE || BENCHMARK || TRACE_RECORD || TRACE_REPLAY || TRACE_IDS) && !DEBUG
+    Serial.begin(serial_baud);
+    #endif //(PROFILE || BENCHMARK || TRACE_RECORD || TRACE_REPLAY || TRACE_IDS) && !DEBUG
+
+    #if TRACE_IDS
+    tracer.begin(&Serial, tr_own_ids);
+    #endif //TRACE_IDS
+
+    #if TRACE_RECORD
+    trace.record(&rs485, &Serial);
+    #elif TRACE_REPLAY
+    trace.replay(&Serial, &Serial, trace_speed);
+    #endif //TRACE_RECORD
+
+    #if BENCHMARK
+    {
+        Benchmark benchmark{};
+        benchmark.run(Serial, parseResponse);
+    }
+    #endif //BENCHMARK
+
+    #if PROFILE
+    profiler.begin();
+    prof_timer.begin(prof_period);
+    #endif //PROFILE
+
+    #if COALESCE
+    flights.begin(co_window);
+    #endif //COALESCE
+
+    #if PRESENCE
+    presence.begin(pr_forget);
+    #endif //PRESENCE
+
+    #if LOCAL_REPORTS
+    rp_timer.begin(rp_period);
+    #endif //LOCAL_REPORTS
+
+    #if LIVENESS
+    lv_timer.begin(lv_check);
+    #endif //LIVENESS
+
+    #if ADMISSION
+    admission.begin(adm_budget);
+    #endif //ADMISSION
+
+    #if ETH_EVENTS
+    client.setTimeout(srvr_rcv);                // headers and json arrive together, nothing to wait for long
+    #endif //ETH_EVENTS
+
+    #if BACKENDS
+    backends.begin(srvr_endpoints, sizeof(srvr_endpoints) / sizeof(srvr_endpoints[0]), bk_hedge_min, bk_hedge_max);
+    client.setConnectionTimeout(bk_connect);
+    hedge_client.setConnectionTimeout(bk_connect);
+    bk_timer.begin(bk_check_period);
+    #endif //BACKENDS
+
+    #if CARD_INDEX
+    {
+        #if ci_flash_cs
+        pinMode(ci_flash_cs, OUTPUT);
+        digitalWrite(ci_flash_cs, HIGH);
+        const uint32_t slots[] = { 0, ci_slot_size };
+        #else
+        const uint32_t slots[] = { 0 };
+        #endif //ci_flash_cs
+        if (card_index.begin(readCardIndex, slots, sizeof(slots) / sizeof(slots[0])))
+        {
+            debugln_f("card index v.%lu: %lu cards", card_index.version(), card_index.count());
+        }
+        else
+        {
+            debugln_s("card index: no valid image");
+        }
+    }
+    #endif //CARD_INDEX
+
     ethernetConnect();
+
+    // registry is empty after restart: readers join again one by one
+    #if READER_REGISTRY
+    registry.clear();
+    sendBroadcast(ct_resync, rg_slot_time);
+    #endif //READER_REGISTRY
 }
 
 void loop()
 {
+    // with card index buses are served without link, readers keep sending (er_no_ethr_cnctn 2)
+    #if CARD_INDEX
+    if (!ethernetConnected() && card_index.count() > 0)
+    {
+        if (!eth_offline)
+        {
+            debugln_s("ethernet lost, lookups by card index");
+            eth_offline = true;
+            sendBroadcast(er_no_ethr_cnctn, 2);
+        }
+    }
+    else if (eth_offline)
+    {
+        eth_offline = false;
+        ethernetConnect();
+    }
+    else
+    #endif //CARD_INDEX
     if (!ethernetConnected())
     {
         ethernetConnect();
     }
 
-    if (easy_transfer.receiveData())
+    // priority command goes to readers before frames waiting in buffers of segments are handled
+    #if PRIORITY
+    uint8_t command;
+    if (priority.receive(command))
     {
-        debugln_f("\nET << \t[ %u; %lu; %u; %u ]", 
-            message.device_id, message.card_id, message.state_id, message.other_id);
+        startPriority(command);
+    }
+    if (priority.due())
+    {
+        sendBroadcast(ct_priority, priority.command(), priority.sequence());
+    }
+    #endif //PRIORITY
+
+    // one frame at most from each segment per loop, so busy segment does not hold the others
+    bool idle = true;
+    for (uint8_t i = 0; i < rs_segments; i++)
+    {
+        segment = &segments[i];
+
+        profile_start(p_et_receive);
+        const Message* received = segment->channel.receive();
+        profile_stop(p_et_receive);
+        if (received)
+        {
+            segment->message = received;
+            idle = false;
+            debugln_f("\nET%u << \t[ %u; %lu; %u; %u ]", i,
+                segment->message->device_id, segment->message->card_id, segment->message->state_id, segment->message->other_id);
+
+            if (handleControl())
+                continue;
 
-        sendServer();
-        receiveServer();
+            // trace id of reader is in other_id of lookup
+            #if TRACE_IDS
+            tracer.open(segment->message->device_id, segment->message->other_id);
+            tracer.stage(segment->message->device_id, F("rx"));
+            #endif //TRACE_IDS
+
+            requestServer();
+        }
     }
+
+    #if ETH_EVENTS
+    finishLookup();
+    #endif //ETH_EVENTS
+
+    #if UDP_TRANSPORT
+    UdpLink::Result result;
+    while (udp_link.update(result))
+    {
+        segment = &segments[result.tag];
+
+        // no udp reply: the same request via http
+        if (result.timeout)
+        {
+            debugln_s("udp timeout, http fallback");
+            lookup.set(result.device_id, result.card_id, 0, 0);
+            #if ETH_EVENTS
+            lookupServer(lookup);
+            continue;
+            #endif //ETH_EVENTS
+            #if ADMISSION
+            uint32_t started = millis() - result.elapsed;
+            #endif //ADMISSION
+            if (sendServer(lookup))
+            {
+                receiveServer(lookup);
+            }
+            #if ADMISSION
+            admission.sample(millis() - started);
+            #endif //ADMISSION
+        }
+        else
+        {
+            debugln_f("udp  <<\t{ 'kod='%u; 'id'=%lu, 'status'=%u }", 
+                result.device_id, result.card_id, result.state_id);
+            #if TRACE_IDS
+            tracer.stage(result.device_id, F("srv<"));
+            #endif //TRACE_IDS
+            #if ADMISSION
+            admission.sample(result.elapsed);
+            #endif //ADMISSION
+            answerLookup(
+                result.device_id,
+                result.card_id,
+                result.state_id
+            );
+            rememberDecision(result.device_id, result.card_id, result.state_id);
+        }
+    }
+    #endif //UDP_TRANSPORT
+
+    #if DNS_CACHE
+    dns_cache.update();
+    #endif //DNS_CACHE
+
+    #if CLUSTER
+    Cluster::Packet passage;
+    while (cluster.update(passage))
+    {
+        debugln_f("peer <<\tcard %lu passed %u", passage.card_id, passage.device_id);
+        #if PRESENCE
+        presence.pass(passage.card_id, passage.device_id, passage.ttl);
+        #endif //PRESENCE
+    }
+    #endif //CLUSTER
+
+    // dead, revived and flapping readers go to journal
+    #if LIVENESS
+    if (lv_timer.update())
+    {
+        registry.expire(lv_dead, lv_flap_window, lv_flaps);
+        uint8_t changed;
+        while (registry.changed(changed))
+        {
+            const ReaderRegistry::Reader& reader = registry.reader(changed);
+            debugln_f("reader %u liveness %u", reader.device_id, reader.liveness);
+            reports.push(reader.device_id, 0, jr_liveness, reader.liveness);
+        }
+    }
+    #endif //LIVENESS
+
+    // journal is delivered only when readers are quiet and server keeps up with them
+    #if LOCAL_REPORTS && ADMISSION
+    idle = idle && !admission.overloaded(queuedLookups());
+    #endif //LOCAL_REPORTS && ADMISSION
+    #if LOCAL_REPORTS && ETH_EVENTS
+    idle = idle && !http_busy;
+    #endif //LOCAL_REPORTS && ETH_EVENTS
+    #if CARD_INDEX
+    idle = idle && !eth_offline;
+    #endif //CARD_INDEX
+    #if LOCAL_REPORTS
+    if (idle && reports.size() > 0 && rp_timer.update())
+    {
+        reportServer();
+    }
+    #endif //LOCAL_REPORTS
+
+    #if BACKENDS
+    if (idle && bk_timer.update())
+    {
+        checkServers();
+    }
+    #endif //BACKENDS
+
+    #if PROFILE
+    if (prof_timer.update())
+    {
+        profiler.report(Serial, prof_names, prof_baselines, p_count, prof_tolerance);
+        profiler.reset();
+
+        #if DECISION_CACHE
+        Serial.print(F("cache\thits="));
+        Serial.print(cache.hits());
+        Serial.print(F("\tmisses="));
+        Serial.println(cache.misses());
+        #endif //DECISION_CACHE
+
+        #if ADMISSION
+        Serial.print(F("server\tlatency="));
+        Serial.print(admission.estimate());
+        Serial.print(F("\tbusy="));
+        Serial.println(admission.rejected());
+        #endif //ADMISSION
+
+        #if LIVENESS
+        Serial.print(F("readers\talive="));
+        Serial.print(registry.count(ReaderRegistry::l_alive));
+        Serial.print(F("\tdead="));
+        Serial.print(registry.count(ReaderRegistry::l_dead));
+        Serial.print(F("\tflapping="));
+        Serial.println(registry.count(ReaderRegistry::l_flapping));
+        #endif //LIVENESS
+
+        #if PRIORITY
+        Serial.print(F("priority\tfanout="));
+        Serial.print(priority.fanout());
+        Serial.print(F("\tlongest="));
+        Serial.print(priority.longest());
+        Serial.print(F("\tincomplete="));
+        Serial.print(priority.incomplete());
+        Serial.print(F("\trejected="));
+        Serial.println(priority.rejected());
+        #endif //PRIORITY
+    }
+    #endif //PROFILE
 }
 
 #pragma region F_DESCRIPTION
@@ -199,73 +932,612 @@ void ethernetConnect()
     debugln_f("DHCP succeeded. ip: %u.%u.%u.%u", 
         Ethernet.localIP()[0], Ethernet.localIP()[1], Ethernet.localIP()[2], Ethernet.localIP()[3]);
 
+    #if UDP_TRANSPORT
+    if (!udp_link.begin(srvr_name, srvr_udp_port, udp_local_port))
+    {
+        debugln_s("udp: server address not resolved, using http");
+    }
+    #endif //UDP_TRANSPORT
+
+    #if ETH_EVENTS
+    eth_events.begin(eth_int_pin);
+    #endif //ETH_EVENTS
+
+    // server hosts are resolved now, swipes only use cached addresses
+    #if DNS_CACHE
+    dns_cache.begin(Ethernet.dnsServerIP(), dns_local_port);
+    #if BACKENDS
+    for (uint8_t i = 0; i < backends.count(); i++)
+    {
+        if (!dns_cache.add(backends.endpoint(i).host))
+        {
+            debugln_f("dns: %s not resolved", backends.endpoint(i).host);
+        }
+    }
+    #else
+    if (!dns_cache.add(srvr_name))
+    {
+        debugln_s("dns: server not resolved");
+    }
+    #endif //BACKENDS
+    #endif //DNS_CACHE
+
+    #if CLUSTER
+    if (!cluster.begin(IPAddress(cl_group), cl_port, cl_key, &cache, cache_ttl_card, cl_accepted))
+    {
+        debugln_s("cluster: multicast group not joined");
+    }
+    #endif //CLUSTER
+
+    #if PRIORITY
+    if (!priority.begin(pb_port, pb_repeat, pb_tries, pb_key, IPAddress(pb_admin), pb_nonce_address))
+    {
+        debugln_s("priority: command port not opened");
+    }
+    #endif //PRIORITY
+
     sendBroadcast(er_no_ethr_cnctn, 1);
     debugln();
 }
 
-void sendServer()
+bool handleControl()
 {
-    // no ethernet or server connection, trying to reconnect
-    if (!client.connect(srvr_name, srvr_port))
+    const Message& message = *segment->message;
+    unsigned short state_id = message.state_id;
+
+    // readers without control codes register by lookup of card 0
+    #if READER_REGISTRY
+    uint8_t index = segment - segments;
+    if (message.card_id == 0 && state_id == st_unknown)
+    {
+        state_id = ct_register;
+    }
+    #endif //READER_REGISTRY
+
+    switch (state_id)
+    {
+    // reader rejected card itself and only reports it
+    #if BLOCK_FILTER
+    case ct_filter_hit:
+        reports.push(message.device_id, message.card_id, ct_filter_hit);
+        return true;
+    #endif //BLOCK_FILTER
+
+    // acknowledgement carries time of event: reader repeats it until then
+    #if DOOR_EVENTS
+    case ct_door:
+        if (newDoorEvent(message))
+        {
+            reports.push(message.device_id, message.card_id, ct_door, message.other_id);
+        }
+        #if READER_REGISTRY
+        registry.seen(message.device_id, index);
+        #endif //READER_REGISTRY
+        sendData(message.device_id, message.card_id, ct_ack, ct_door);
+        return true;
+    #endif //DOOR_EVENTS
+
+    #if READER_REGISTRY
+    case ct_register:
+        if (registry.join(message.device_id, index))
+        {
+            debugln_f("reader %u joined segment %u", message.device_id, index);
+        }
+        reports.push(message.device_id, 0, jr_registered, index);
+        sendData(message.device_id, registry.position(message.device_id), ct_ack, ct_register);
+        return true;
+
+    // heartbeat tells heads of reader, they share liveness
+    case ct_heartbeat:
+        if (message.other_id > 1)
+        {
+            registry.group(message.device_id, message.other_id);
+        }
+        registry.seen(message.device_id, index);
+        sendData(message.device_id, 0, ct_ack, ct_heartbeat);
+        return true;
+
+    // only changes of status go to journal
+    case ct_status:
+        if (registry.status(message.device_id, index, message.other_id))
+        {
+            reports.push(message.device_id, 0, jr_status, message.other_id);
+        }
+        sendData(message.device_id, 0, ct_ack, ct_status);
+        return true;
+    #endif //READER_REGISTRY
+
+    // reader applied priority command: every its head is acknowledged, nothing is answered
+    #if PRIORITY
+    case ct_ack:
     {
+        uint16_t readers = 0;
+        for (unsigned short h = 0; h < message.other_id && h < REGISTRY_READERS; h++)
+        {
+            int8_t position = registry.position(message.device_id + h);
+            if (position >= 0)
+                readers |= 1 << position;
+        }
+        registry.seen(message.device_id, index);
+        if (priority.ack(message.card_id, readers))
+        {
+            debugln_f("priority %u: fan-out %u ms", priority.command(), priority.fanout());
+        }
+        return true;
+    }
+    #endif //PRIORITY
+
+    default:
+        #if READER_REGISTRY
+        registry.seen(message.device_id, index);
+        #endif //READER_REGISTRY
+
+        // control of feature switched off on gateway (or unknown one) is dropped, not looked up
+        if (state_id >= ct_first && state_id <= ct_last)
+        {
+            debugln_f("control <<\tkod=%u state %u not handled", message.device_id, state_id);
+            return true;
+        }
+        return false;
+    }
+}
+
+void requestServer()
+{
+    // request is copied and the copy goes down the lookup path: answers sent meanwhile (optimistic grant before
+    // verification lookup) must not change it
+    const Message message = *segment->message;
+
+    // lookups of readers which missed lockdown are denied without server
+    #if PRIORITY
+    if (pb_mode == pc_lockdown)
+    {
+        debugln_f("lockdown <<\t{ 'kod='%u; 'id'=%lu, 'status'=%u }",
+            message.device_id, message.card_id, st_denied);
         sendData(
-            message.device_id, 
-            message.card_id, 
-            er_no_srvr_cnctn,
+            message.device_id,
+            message.card_id,
+            st_denied,
             0
         );
         return;
     }
+    #endif //PRIORITY
+
+    // anti-passback violation is known without server, which gets it later for journal
+    #if PRESENCE
+    if (!presence.allows(message.card_id, readerDirection(message.device_id)))
+    {
+        debugln_f("local <<\t{ 'kod='%u; 'id'=%lu, 'status'=%u }", 
+            message.device_id, message.card_id, st_re_entry);
+        reports.push(message.device_id, message.card_id, st_re_entry);
+        sendData(
+            message.device_id,
+            message.card_id,
+            st_re_entry,
+            0
+        );
+        return;
+    }
+    #endif //PRESENCE
+
+    #if DECISION_CACHE
+    unsigned short state_id;
+    if (cache.get(message.device_id, message.card_id, state_id))
+    {
+        debugln_f("cache <<\t{ 'kod='%u; 'id'=%lu, 'status'=%u }", 
+            message.device_id, message.card_id, state_id);
+        sendData(
+            message.device_id,
+            message.card_id,
+            state_id,
+            0
+        );
+        return;
+    }
+    #endif //DECISION_CACHE
+
+    #if COALESCE
+    unsigned short recent_state;
+    switch (flights.join(message.card_id, message.device_id, segment - segments, recent_state))
+    {
+    // the same card is being looked up: answer comes with its result
+    case Coalescer::c_joined:
+        debugln_f("wait <<\tid=%lu&kod=%u", message.card_id, message.device_id);
+        return;
+
+    case Coalescer::c_recent:
+        debugln_f("recent <<\t{ 'kod='%u; 'id'=%lu, 'status'=%u }",
+            message.device_id, message.card_id, recent_state);
+        sendData(
+            message.device_id,
+            message.card_id,
+            recent_state,
+            0
+        );
+        return;
+
+    default:
+        break;
+    }
+    #endif //COALESCE
+
+    // no link: index decides at once
+    #if CARD_INDEX
+    if (eth_offline)
+    {
+        answerLookup(message.device_id, message.card_id, er_no_ethr_cnctn);
+        return;
+    }
+    #endif //CARD_INDEX
+
+    // lookup would not fit into reader timeout: reader retries later instead of waiting for nothing.
+    // duplicates are already answered above and cost no lookup
+    #if ADMISSION
+    uint16_t retry_after = admission.admit(queuedLookups());
+    if (retry_after > 0)
+    {
+        debugln_f("busy <<\tid=%lu&kod=%u retry %u", message.card_id, message.device_id, retry_after);
+        #if COALESCE
+        flights.finish(message.card_id, st_busy, false);
+        #endif //COALESCE
+        sendData(
+            message.device_id,
+            message.card_id,
+            st_busy,
+            retry_after
+        );
+        return;
+    }
+    #endif //ADMISSION
+
+    // door opens now, lookup goes on and only checks this decision
+    #if OPTIMISTIC
+    if (allowed.grant(message.device_id, message.card_id))
+    {
+        debugln_f("grant <<\tid=%lu&kod=%u", message.card_id, message.device_id);
+        sendData(
+            message.device_id,
+            message.card_id,
+            st_allow,
+            0
+        );
+    }
+    #endif //OPTIMISTIC
+
+    #if UDP_TRANSPORT
+    if (udp_link.request(message.device_id, message.card_id, segment - segments))
+    {
+        debugln_f("udp  >>\tid=%lu&kod=%u", message.card_id, message.device_id);
+        #if TRACE_IDS
+        tracer.stage(message.device_id, F("srv>"));
+        #endif //TRACE_IDS
+        return;
+    }
+    #endif //UDP_TRANSPORT
+
+    lookupServer(message);
+}
+
+void lookupServer(const Message& message)
+{
+    // udp fallback and waiting lookups of lost link
+    #if CARD_INDEX
+    if (eth_offline)
+    {
+        answerLookup(message.device_id, message.card_id, er_no_ethr_cnctn);
+        return;
+    }
+    #endif //CARD_INDEX
+
+    // client is taken by other lookup: this one waits for it
+    #if ETH_EVENTS
+    if (http_busy)
+    {
+        http_waiting.push(message.device_id, message.card_id, 0, segment - segments);
+        return;
+    }
+    #endif //ETH_EVENTS
+
+    #if ADMISSION || ETH_EVENTS
+    uint32_t started = millis();
+    #endif //ADMISSION || ETH_EVENTS
+
+    profile_start(p_send_server);
+    bool sent = sendServer(message);
+    profile_stop(p_send_server);
+
+    // answer is taken by finishLookup() when it comes, buses are served meanwhile
+    #if ETH_EVENTS
+    if (sent)
+    {
+        eth_events.take(client.getSocketNumber());  // connection event is not an answer
+        http_busy = true;
+        http_message = message;
+        http_segment = segment;
+        http_sent = started;
+        return;
+    }
+    #else
+    if (sent)
+    {
+        profile_start(p_receive_server);
+        receiveServer(message);
+        profile_stop(p_receive_server);
+    }
+    #endif //ETH_EVENTS
+
+    #if ADMISSION
+    admission.sample(millis() - started);
+    #endif //ADMISSION
+}
+
+void finishLookup()
+{
+    #if ETH_EVENTS
+    eth_events.poll();
+    if (!http_busy)
+        return;
+
+    uint8_t events = eth_events.take(client.getSocketNumber());
+    bool expired = millis() - http_sent > eth_answer;
+    if (!(events & (SocketEvents::e_received | SocketEvents::e_disconnected)) && !expired)
+        return;
+
+    // request of reader is kept aside: the bus brought new frames meanwhile
+    http_busy = false;
+    segment = http_segment;
+
+    if (client.available())
+    {
+        profile_start(p_receive_server);
+        if (client.find("\r\n\r\n"))
+        {
+            receiveServer(http_message);
+        }
+        else
+        {
+            client.stop();
+            answerLookup(http_message.device_id, http_message.card_id, er_request);
+        }
+        profile_stop(p_receive_server);
+    }
+    else
+    {
+        client.stop();
+        answerLookup(http_message.device_id, http_message.card_id, er_timeout);
+    }
+
+    #if ADMISSION
+    admission.sample(millis() - http_sent);
+    #endif //ADMISSION
+
+    Message next;
+    if (http_waiting.peek(next))
+    {
+        http_waiting.pop();
+        segment = &segments[next.other_id];
+        lookup.set(next.device_id, next.card_id, 0, 0);
+        lookupServer(lookup);
+    }
+    #endif //ETH_EVENTS
+}
+
+bool connectServer(EthernetClient& http, const char* host, uint16_t port)
+{
+    #if DNS_CACHE
+    IPAddress address;
+    if (dns_cache.get(host, address))
+    {
+        return http.connect(address, port);
+    }
+    #endif //DNS_CACHE
+    return http.connect(host, port);
+}
+
+bool sendServer(const Message& message)
+{
+    // no ethernet or server connection, trying to reconnect
+    #if BACKENDS
+    // failover: every healthy server is tried, the fastest first
+    uint8_t tried = 0;
+    while ((srvr_current = backends.select(tried)) >= 0)
+    {
+        tried |= 1 << srvr_current;
+        if (connectServer(client, backends.endpoint(srvr_current).host, backends.endpoint(srvr_current).port))
+            break;
+        backends.failure(srvr_current);
+    }
+    if (srvr_current < 0)
+    #else
+    if (!connectServer(client, srvr_name, srvr_port))
+    #endif //BACKENDS
+    {
+        answerLookup(
+            message.device_id,
+            message.card_id,
+            er_no_srvr_cnctn
+        );
+        return false;
+    }
     
     // connection established
-    client.print(srvr_rqst);
-    client.print("id=");
-    client.print(message.card_id);
-    client.print("&kod=");
-    client.print(message.device_id);
-    client.println(" HTTP/1.1");
-    client.print("Host: ");
-    client.println(srvr_name);
-    client.println("Connection: close");
-    client.println();
-    client.println();
+    #if BACKENDS
+    printLookup(client, backends.endpoint(srvr_current).host, message);
+    srvr_sent = millis();
+    #else
+    printLookup(client, srvr_name, message);
+    #endif //BACKENDS
 
     debug_s("web  >> skdmk.fd.mk.us/skd.mk/baseadd2.php?id=");
     debug(message.card_id);
     debug_s("&kod=");
     debugln(message.device_id);
 
+    #if TRACE_IDS
+    tracer.stage(message.device_id, F("srv>"));
+    #endif //TRACE_IDS
+
+    // headers are waited for with answer (hedged request may answer first, or socket event comes)
+    #if !BACKENDS && !ETH_EVENTS
     // rare error check
     if (!client.find("\r\n\r\n"))
     {
         client.stop();
-        sendData(
+        answerLookup(
             message.device_id,
             message.card_id,
-            er_request,
-            0
+            er_request
         );
+        return false;
     }
+    #endif //!BACKENDS && !ETH_EVENTS
+    return true;
 }
 
-void receiveServer()
+void printLookup(EthernetClient& http, const char* host, const Message& message, bool hedge)
 {
+    HttpRequest request;
+    request.begin(PSTR(srvr_rqst));
+    request.param(PSTR("id="), message.card_id);
+    request.param(PSTR("&kod="), message.device_id);
+    if (hedge)
+    {
+        request.text(PSTR("&hedge=1"));
+    }
+    #if TRACE_IDS
+    uint16_t trace = tracer.find(message.device_id);
+    if (trace != 0)
+    {
+        request.param(PSTR("&trace="), trace);
+    }
+    #endif //TRACE_IDS
+    request.end(host);
+    request.send(http);
+}
+
+EthernetClient& waitServers(const Message& message)
+{
+    #if BACKENDS
+    // no answer for usual time of server: the same request goes to the next one too, the first answer is taken
+    uint16_t hedge_delay = backends.hedgeDelay(srvr_current);
+    int8_t hedged = -1;
+    bool hedge_tried = false;
+    uint32_t hedge_sent = 0;
+    bool closed = false;                        // server closed connection without answer
+    uint32_t waited;
+    while ((waited = millis() - srvr_sent) <= bk_answer)
+    {
+        if (client.available())
+        {
+            backends.sample(srvr_current, waited);
+            client.find("\r\n\r\n");
+            return client;
+        }
+
+        if (hedged >= 0 && hedge_client.available())
+        {
+            debugln_f("hedge <<\t%s", backends.endpoint(hedged).host);
+            backends.sample(hedged, millis() - hedge_sent);
+            if (!closed)
+            {
+                backends.sample(srvr_current, waited);  // it is at least that slow
+            }
+            hedge_client.find("\r\n\r\n");
+            return hedge_client;
+        }
+
+        // closed connection will not answer: it is a failure now, not after bk_answer
+        if (!closed && !client.connected())
+        {
+            debugln_f("closed <<\t%s", backends.endpoint(srvr_current).host);
+            closed = true;
+            backends.failure(srvr_current);
+        }
+        if (hedged >= 0 && !hedge_client.connected())
+        {
+            debugln_f("closed <<\t%s", backends.endpoint(hedged).host);
+            backends.failure(hedged);
+            hedged = -1;
+        }
+
+        // closed server fails over at once (request is not a duplicate then)
+        if (!hedge_tried && (closed || waited >= hedge_delay))
+        {
+            hedge_tried = true;
+            hedged = backends.select(1 << srvr_current);
+            if (hedged >= 0 && connectServer(hedge_client, backends.endpoint(hedged).host, backends.endpoint(hedged).port))
+            {
+                debugln_f("hedge >>\t%s", backends.endpoint(hedged).host);
+                printLookup(hedge_client, backends.endpoint(hedged).host, message, !closed);
+                hedge_sent = millis();
+            }
+            else if (hedged >= 0)
+            {
+                backends.failure(hedged);
+                hedged = -1;
+            }
+        }
+
+        // nobody is left to answer
+        if (closed && hedged < 0)
+            return client;
+    }
+
+    // nobody answered
+    backends.failure(srvr_current);
+    if (hedged >= 0)
+    {
+        backends.failure(hedged);
+    }
+    #endif //BACKENDS
+    return client;
+}
+
+void checkServers()
+{
+    #if BACKENDS
+    int8_t server = backends.due();
+    if (server < 0)
+        return;
+
+    bool up = connectServer(client, backends.endpoint(server).host, backends.endpoint(server).port);
+    client.stop();
+    backends.check(server, up);
+    debugln_f("server %s is %s", backends.endpoint(server).host, up ? "up" : "down");
+    #endif //BACKENDS
+}
+
+void receiveServer(const Message& message)
+{
+    #if BACKENDS
+    EthernetClient& http = waitServers(message);
+    #else
+    EthernetClient& http = client;
+
     // smart receive waiting
     unsigned short counter = 0;
     while (counter <= srvr_rcv)
     {
-        if (client.available())
+        if (http.available())
             break;
 
         delay(1);
         counter++;
     }
+    #endif //BACKENDS
 
     // available data in cleint for read
-    if (client.available())
+    if (http.available())
     {
-        StaticJsonDocument<256> json;
-        DeserializationError error = deserializeJson(json, client);
+        Message response;
+        profile_start(p_json_parse);
+        DeserializationError error = parseResponse(http, response);
+        profile_stop(p_json_parse);
+
+        #if TRACE_IDS
+        tracer.stage(message.device_id, F("srv<"));
+        #endif //TRACE_IDS
 
         // deserialization error
         if (error)
@@ -273,19 +1545,18 @@ void receiveServer()
             debug_s("json error: ");
             debugln(error.c_str());
             
-            sendData(
-                message.device_id, 
-                message.card_id, 
-                er_json, 
-                0
+            answerLookup(
+                message.device_id,
+                message.card_id,
+                er_json
             );
         }
         // successfully received response from server
         else
         {
-            unsigned short  json_device_id = strtoul(json["kod"].as<const char*>(), NULL, 0);
-            unsigned long   json_card_id   = strtoul(json["id"].as<const char*>(), NULL, 0);
-            unsigned short  json_state_id  = json["status"].as<unsigned short>();
+            unsigned short  json_device_id = response.device_id;
+            unsigned long   json_card_id   = response.card_id;
+            unsigned short  json_state_id  = response.state_id;
 
             debugln_f("json <<\t{ 'kod='%u; 'id'=%lu, 'status'=%u }", 
                 json_device_id, json_card_id, json_state_id);
@@ -293,60 +1564,346 @@ void receiveServer()
             // no response from server
             if (json_device_id == 0 && json_card_id == 0 && json_state_id == 0)
             {
-                sendData(
+                answerLookup(
                     message.device_id,
                     message.card_id,
-                    er_no_response,
-                    0
+                    er_no_response
                 );
             }
             // correct response
             else
             {
-                sendData(
+                answerLookup(
                     json_device_id,
                     json_card_id,
-                    json_state_id,
-                    0
+                    json_state_id
                 );
+                rememberDecision(json_device_id, json_card_id, json_state_id);
             }
         }
     }
     else
     {
-        sendData(
+        answerLookup(
             message.device_id,
             message.card_id,
-            er_timeout,
+            er_timeout
+        );
+    }
+
+    client.stop();
+    #if BACKENDS
+    hedge_client.stop();
+    #endif //BACKENDS
+}
+
+DeserializationError parseResponse(Stream& stream, Message& response)
+{
+    StaticJsonDocument<256> json;
+    DeserializationError error = deserializeJson(json, stream);
+    if (!error)
+    {
+        response.set(
+            strtoul(json["kod"].as<const char*>(), NULL, 0),
+            strtoul(json["id"].as<const char*>(), NULL, 0),
+            json["status"].as<unsigned short>(),
             0
         );
     }
+    return error;
+}
+
+void answerLookup(unsigned short device_id, unsigned long card_id, unsigned short state_id)
+{
+    // server is not available: cards of index are allowed without it
+    #if CARD_INDEX
+    if (state_id >= er_no_srvr_cnctn && card_index.contains(card_id))
+    {
+        debugln_f("index <<\tid=%lu allowed offline", card_id);
+        reports.push(device_id, card_id, jr_offline_allow, state_id);
+        state_id = st_allow;
+    }
+    #endif //CARD_INDEX
+
+    bool answered = false;                      // reader already got optimistic grant
+
+    // error is not an answer: optimistic grant stays as it is
+    #if OPTIMISTIC
+    bool agreed = true;
+    answered = state_id < er_no_srvr_cnctn
+        && allowed.settle(device_id, card_id, state_id, st_allow, agreed);
+    if (!agreed)
+    {
+        debugln_f("alert: grant id=%lu&kod=%u not confirmed, status=%u", card_id, device_id, state_id);
+        reports.push(device_id, card_id, jr_unconfirmed, state_id);
+    }
+    #endif //OPTIMISTIC
+
+    if (!answered)
+    {
+        sendData(device_id, card_id, state_id, 0);
+    }
+
+    #if COALESCE
+    // errors are given to waiting readers, but not to new swipes
+    flights.finish(card_id, state_id, state_id < er_no_srvr_cnctn);
+
+    Segment* origin = segment;
+    Coalescer::Waiter waiter;
+    while (flights.waiter(card_id, waiter, state_id))
+    {
+        segment = &segments[waiter.segment];
+        sendData(waiter.device_id, card_id, state_id, 0);
+    }
+    segment = origin;
+    #endif //COALESCE
+}
+
+void rememberDecision(unsigned short device_id, unsigned long card_id, unsigned short state_id)
+{
+    switch (state_id)
+    {
+    // answer is about card itself, the same for every device
+    case st_invalid:
+    case st_blocked:
+        #if DECISION_CACHE
+        cache.put(CACHE_ANY, card_id, state_id, cache_ttl_card);
+        #endif //DECISION_CACHE
+        #if CLUSTER
+        cluster.share(CACHE_ANY, card_id, state_id, cache_ttl_card);
+        #endif //CLUSTER
+        #if BLOCK_FILTER
+        sendBroadcast(ct_filter_add, 0, card_id);
+        #endif //BLOCK_FILTER
+        break;
+
+    #if DECISION_CACHE
+    case st_denied:
+        cache.put(device_id, card_id, state_id, cache_ttl_denied);
+        #if CLUSTER
+        cluster.share(device_id, card_id, state_id, cache_ttl_denied);
+        #endif //CLUSTER
+        break;
+    #endif //DECISION_CACHE
+
+    // passage changes card presence (anti-passback), so earlier decisions about card are stale
+    case st_allow:
+        #if DECISION_CACHE
+        cache.invalidate(card_id);
+        #endif //DECISION_CACHE
+        #if OPTIMISTIC
+        allowed.add(device_id, card_id);
+        #endif //OPTIMISTIC
+        #if PRESENCE
+        presence.pass(card_id, device_id, readerDirection(device_id));
+        #endif //PRESENCE
+        #if CLUSTER
+        cluster.presence(device_id, card_id, state_id, readerDirection(device_id));
+        #endif //CLUSTER
+        break;
+
+    // re-entry depends on presence, errors are not decisions
+    default:
+        break;
+    }
+}
+
+uint8_t readerDirection(unsigned short device_id)
+{
+    for (uint8_t i = 0; i < sizeof(pr_readers) / sizeof(pr_readers[0]); i++)
+    {
+        if (pgm_read_word(&pr_readers[i].device_id) == device_id)
+            return pgm_read_byte(&pr_readers[i].direction);
+    }
+    return PresenceTable::d_none;
+}
+
+void readCardIndex(uint32_t address, void* buffer, uint16_t length)
+{
+    #if CARD_INDEX && ci_flash_cs
+    // spi flash read command (0x03) with 24-bit address
+    SPI.beginTransaction(SPISettings(8000000, MSBFIRST, SPI_MODE0));
+    digitalWrite(ci_flash_cs, LOW);
+    SPI.transfer(0x03);
+    SPI.transfer(address >> 16);
+    SPI.transfer(address >> 8);
+    SPI.transfer(address);
+    for (uint16_t i = 0; i < length; i++)
+    {
+        ((uint8_t*)buffer)[i] = SPI.transfer(0);
+    }
+    digitalWrite(ci_flash_cs, HIGH);
+    SPI.endTransaction();
+    #elif CARD_INDEX
+    if (address + length <= sizeof(card_index_image))
+    {
+        memcpy_P(buffer, card_index_image + address, length);
+    }
+    else
+    {
+        memset(buffer, 0, length);
+    }
+    #endif //CARD_INDEX && ci_flash_cs
+}
+
+uint8_t queuedLookups()
+{
+    // every frame is header (2), size, message and checksum
+    uint8_t queued = 0;
+    for (uint8_t i = 0; i < rs_segments; i++)
+    {
+        queued += segments[i].stream->available() / (sizeof(Message) + 4);
+    }
+    #if ETH_EVENTS
+    queued += http_waiting.size();
+    #endif //ETH_EVENTS
+    return queued;
+}
+
+void reportServer()
+{
+    #if LOCAL_REPORTS
+    Message report;
+    reports.peek(report);
+
+    #if BACKENDS
+    const Backends::Endpoint& server = backends.endpoint(max(backends.select(), (int8_t)0));
+    const char* host = server.host;
+    uint16_t port = server.port;
+    #else
+    const char* host = srvr_name;
+    uint16_t port = srvr_port;
+    #endif //BACKENDS
+
+    // server is not available: report waits for next try
+    if (!connectServer(client, host, port))
+        return;
+
+    HttpRequest request;
+    request.begin(PSTR(srvr_jrnl));
+    request.param(PSTR("id="), report.card_id);
+    request.param(PSTR("&kod="), report.device_id);
+    request.param(PSTR("&status="), report.state_id);
+    if (report.other_id != 0)
+    {
+        request.param(PSTR("&other="), report.other_id);
+    }
+    request.end(host);
+    request.send(client);
+
+    debugln_f("web  >> report id=%lu&kod=%u&status=%u", report.card_id, report.device_id, report.state_id);
+
+    // response body is not needed, only confirmation that server got request
+    if (client.find("\r\n\r\n"))
+    {
+        reports.pop();
 
+        // server answer to rejected card shows whether reader filter is still right
+        #if BLOCK_FILTER
+        Message response;
+        if (report.state_id == ct_filter_hit && !parseResponse(client, response)
+            && response.state_id != st_unknown && response.state_id != st_blocked && response.state_id != st_invalid)
+        {
+            debugln_f("card %lu is not blocked anymore", report.card_id);
+            sendBroadcast(ct_filter_remove, 0, report.card_id);
+        }
+        #endif //BLOCK_FILTER
+    }
     client.stop();
+    #endif //LOCAL_REPORTS
 }
 
 void sendData(unsigned short device_id, unsigned long card_id, unsigned short state_id, unsigned short other_id)
 {
+    // request being handled stays as it is: answer is built aside
+    Message message;
     message.set(device_id, card_id, state_id, other_id);
 
-    debugln_f("ET >> \t[ %u; %lu; %u; %u ]", 
+    debugln_f("ET%u >> \t[ %u; %lu; %u; %u ]", (uint8_t)(segment - segments),
         message.device_id, message.card_id, message.state_id, message.other_id);
 
-    easy_transfer.sendData();
+    profile_start(p_et_send);
+    segment->channel.send(message);
+    profile_stop(p_et_send);
 
-    message.clean();
+    #if TRACE_IDS
+    tracer.close(device_id, F("tx"), state_id);
+    #endif //TRACE_IDS
 }
 
-void sendBroadcast(unsigned short state_id, unsigned short other_id)
+void sendBroadcast(unsigned short state_id, unsigned short other_id, unsigned long card_id)
 {
-    message.set(broadcast_id, 0, state_id, other_id);
+    Message message;
+    message.set(broadcast_id, card_id, state_id, other_id);
 
-    debugln_f("ET >>> \t[ %u; %lu; %u; %u ]", 
-        message.device_id, message.card_id, message.state_id, message.other_id);
+    for (uint8_t i = 0; i < rs_segments; i++)
+    {
+        debugln_f("ET%u >>> \t[ %u; %lu; %u; %u ]", i,
+            message.device_id, message.card_id, message.state_id, message.other_id);
+
+        segments[i].channel.send(message);
+    }
+}
 
-    easy_transfer.sendData();
+void startPriority(uint8_t command)
+{
+    #if PRIORITY
+    switch (command)
+    {
+    case pc_normal:
+    case pc_unlock_all:
+    case pc_lockdown:
+        pb_mode = command;
+        break;
+
+    case pc_cache_flush:
+        #if DECISION_CACHE
+        cache.clear();
+        #endif //DECISION_CACHE
+        break;
+
+    default:
+        debugln_f("priority: unknown command %u", command);
+        return;
+    }
+
+    // every registered reader head has to acknowledge
+    uint16_t readers = 0;
+    for (uint8_t i = 0; i < REGISTRY_READERS; i++)
+    {
+        if (registry.reader(i).device_id != 0)
+            readers |= 1 << i;
+    }
+    uint16_t sequence = priority.start(command, readers);
+    debugln_f("priority %u: sequence %u, %u readers", command, sequence, registry.size());
+    #endif //PRIORITY
+}
+
+bool newDoorEvent(const Message& message)
+{
+    #if DOOR_EVENTS
+    int8_t slot = -1;
+    for (uint8_t i = 0; i < dr_readers; i++)
+    {
+        if (dr_last[i].device_id == message.device_id)
+        {
+            if (dr_last[i].card_id == message.card_id && dr_last[i].event == message.other_id)
+                return false;
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0)
+    {
+        slot = dr_next;
+        dr_next = (dr_next + 1) % dr_readers;
+    }
 
-    message.clean();
+    dr_last[slot].device_id = message.device_id;
+    dr_last[slot].card_id = message.card_id;
+    dr_last[slot].event = message.other_id;
+    #endif //DOOR_EVENTS
+    return true;
 }
 
 #pragma endregion //F_DESCRIPTION
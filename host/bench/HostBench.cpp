@@ -0,0 +1,330 @@
+// host micro-benchmarks of protocol and decode paths of reader firmware (the same traces as on-device BENCHMARK mode).
+// every benchmark goes through public API of firmware classes, items/s is frames, bits or calls per second.
+//
+//   host/build/host_bench [--benchmark_filter=Channel]
+
+#include <benchmark/benchmark.h>
+#include <vector>
+
+#include <Arduino.h>
+#include <BenchTraces.h>
+#include <Benchmark.h>
+#include <Channel.h>
+#include <FaultStream.h>
+#include <MemoryStream.h>
+#include <Message.h>
+#include <WiegandReader.h>
+
+#if HOST_BENCH_JSON
+#include <ArduinoJson.h>
+#endif //HOST_BENCH_JSON
+
+// card code conversion of reader firmware (main.cpp)
+unsigned long wiegandToDecimal(unsigned long code);
+
+#define bench_frame     (sizeof(Message) + 4)   // bus frame length (header, size, checksum)
+#define bench_swipes    (sizeof(bt_swipes) / sizeof(BenchSwipe))
+
+#pragma region HELPERS
+
+// parses whole trace, returns received frames
+static uint16_t parseTrace(Channel<Message>& channel, MemoryStream& stream, const uint8_t* trace, uint16_t length)
+{
+    uint16_t frames = 0;
+    stream.begin(trace, length);
+    while (stream.available())
+    {
+        if (channel.receive())
+            frames++;
+        // less than header left: parser waits for more data
+        else if (stream.available() < 3)
+            break;
+    }
+    return frames;
+}
+
+// pulses of swipe as they come from reader head: leading parity, data (msb first), trailing parity
+static void pulseSwipe(WiegandReader& reader, const BenchSwipe& swipe)
+{
+    for (uint8_t b = 0; b < swipe.bits; b++)
+    {
+        bool one;
+        if (swipe.bits == 34 && b == 0)
+            one = swipe.parity & 0x02;
+        else if (swipe.bits == 34 && b == 33)
+            one = swipe.parity & 0x01;
+        else
+            one = (swipe.data >> (swipe.bits == 34 ? 32 - b : swipe.bits - 1 - b)) & 1;
+
+        reader.pulse(one);
+    }
+}
+
+#pragma endregion //HELPERS
+
+#pragma region BUS
+
+// frames per second parsed by Channel::receive() from clean bus trace
+static void ChannelReceive(benchmark::State& state)
+{
+    Channel<Message> channel;
+    MemoryStream stream;
+    channel.begin(&stream);
+
+    uint64_t frames = 0;
+    for (auto _ : state)
+        frames += parseTrace(channel, stream, bt_bus_clean, sizeof(bt_bus_clean));
+
+    state.SetItemsProcessed(frames);
+    state.SetBytesProcessed(state.iterations() * sizeof(bt_bus_clean));
+}
+BENCHMARK(ChannelReceive);
+
+// the same frames with recorded line noise between them
+static void ChannelReceiveNoisy(benchmark::State& state)
+{
+    Channel<Message> channel;
+    MemoryStream stream;
+    channel.begin(&stream);
+
+    uint64_t frames = 0;
+    for (auto _ : state)
+        frames += parseTrace(channel, stream, bt_bus_noisy, sizeof(bt_bus_noisy));
+
+    uint16_t clean = sizeof(bt_bus_clean) / bench_frame;
+    state.SetItemsProcessed(frames);
+    state.SetBytesProcessed(state.iterations() * sizeof(bt_bus_noisy));
+    state.counters["lost"] = clean - (double)frames / state.iterations();
+    state.counters["noise_bytes"] = sizeof(bt_bus_noisy) - sizeof(bt_bus_clean);
+}
+BENCHMARK(ChannelReceiveNoisy);
+
+// resync cost: frames of clean trace, each one after given amount of garbage bytes (repeatable pseudo random)
+static void ChannelResync(benchmark::State& state)
+{
+    uint16_t garbage = state.range(0);
+    uint16_t frames = sizeof(bt_bus_clean) / bench_frame;
+
+    std::vector<uint8_t> trace;
+    uint32_t seed = 1;
+    for (uint16_t f = 0; f < frames; f++)
+    {
+        for (uint16_t i = 0; i < garbage; i++)
+        {
+            seed = seed * 1103515245 + 12345;
+            trace.push_back(seed >> 16);
+        }
+        trace.insert(trace.end(), bt_bus_clean + f * bench_frame, bt_bus_clean + (f + 1) * bench_frame);
+    }
+
+    Channel<Message> channel;
+    MemoryStream stream;
+    channel.begin(&stream);
+
+    uint64_t received = 0;
+    for (auto _ : state)
+        received += parseTrace(channel, stream, trace.data(), trace.size());
+
+    state.SetItemsProcessed(received);
+    state.SetBytesProcessed(state.iterations() * trace.size());
+    state.counters["lost"] = frames - (double)received / state.iterations();
+    state.counters["garbage_bytes"] = benchmark::Counter(
+        (double)state.iterations() * frames * garbage, benchmark::Counter::kIsRate);
+}
+BENCHMARK(ChannelResync)->Arg(0)->Arg(4)->Arg(16)->Arg(64);
+
+// frames per second built by Channel::send() (checksum + stream writes)
+static void ChannelSend(benchmark::State& state)
+{
+    Channel<Message> channel;
+    MemoryStream sink;
+    sink.begin(nullptr, 0);
+    channel.begin(&sink);
+
+    uint16_t frames = sizeof(bt_bus_clean) / bench_frame;
+    std::vector<Message> messages(frames);
+    for (uint16_t i = 0; i < frames; i++)
+        memcpy(&messages[i], bt_bus_clean + i * bench_frame + 3, sizeof(Message));
+
+    for (auto _ : state)
+    {
+        for (const Message& message : messages)
+            channel.send(message);
+    }
+
+    state.SetItemsProcessed(state.iterations() * frames);
+    state.SetBytesProcessed(sink.written());
+}
+BENCHMARK(ChannelSend);
+
+// Channel::receive() on damaged line (bit errors, drops, noise per 10000 bytes): goodput and false accepts
+static void ChannelFaultyLine(benchmark::State& state)
+{
+    FrameSource source;
+    FaultStream faults;
+    Channel<Message> channel;
+    source.begin(801);
+    faults.begin(&source, state.range(0), state.range(1), state.range(2), 8);
+    channel.begin(&faults);
+
+    uint64_t good = 0;
+    uint64_t false_accepts = 0;
+    for (auto _ : state)
+    {
+        const Message* received = channel.receive();
+        if (!received)
+            continue;
+        if (source.valid(*received))
+            good++;
+        else
+            false_accepts++;
+    }
+
+    state.SetItemsProcessed(good);
+    state.counters["goodput_%"] = source.frames() ? good * 100.0 / source.frames() : 0;
+    state.counters["false_accepts"] = false_accepts;
+}
+BENCHMARK(ChannelFaultyLine)
+    ->Args({ 0, 0, 0 })
+    ->Args({ 100, 0, 0 })
+    ->Args({ 0, 100, 0 })
+    ->Args({ 0, 0, 100 })
+    ->Args({ 500, 200, 200 });
+
+#pragma endregion //BUS
+
+#pragma region WIEGAND
+
+// bits captured by WiegandReader::pulse() and frames decoded per second
+static void WiegandFrame(benchmark::State& state)
+{
+    WiegandReader reader;
+    uint64_t bits = 0;
+    uint64_t cards = 0;
+
+    for (auto _ : state)
+    {
+        for (uint8_t i = 0; i < bench_swipes; i++)
+        {
+            pulseSwipe(reader, bt_swipes[i]);
+            bits += bt_swipes[i].bits;
+            if (reader.decode())
+                cards++;
+        }
+    }
+
+    benchmark::DoNotOptimize(cards);
+    state.SetItemsProcessed(state.iterations() * bench_swipes);
+    state.counters["bits"] = benchmark::Counter(bits, benchmark::Counter::kIsRate);
+}
+BENCHMARK(WiegandFrame);
+
+// WiegandReader::decode() of captured frame only
+static void WiegandDecode(benchmark::State& state)
+{
+    WiegandReader captured[bench_swipes];
+    for (uint8_t i = 0; i < bench_swipes; i++)
+        pulseSwipe(captured[i], bt_swipes[i]);
+
+    for (auto _ : state)
+    {
+        for (uint8_t i = 0; i < bench_swipes; i++)
+        {
+            WiegandReader reader = captured[i];
+            benchmark::DoNotOptimize(reader.decode());
+            benchmark::DoNotOptimize(reader.getCode());
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * bench_swipes);
+}
+BENCHMARK(WiegandDecode);
+
+// card code conversion of firmware for decoded cards
+static void WiegandToDecimal(benchmark::State& state)
+{
+    std::vector<unsigned long> codes;
+    for (uint8_t i = 0; i < bench_swipes; i++)
+    {
+        WiegandReader reader;
+        pulseSwipe(reader, bt_swipes[i]);
+        if (reader.decode())
+            codes.push_back(reader.getCode());
+    }
+
+    for (auto _ : state)
+    {
+        for (unsigned long code : codes)
+            benchmark::DoNotOptimize(wiegandToDecimal(code));
+    }
+
+    state.SetItemsProcessed(state.iterations() * codes.size());
+}
+BENCHMARK(WiegandToDecimal);
+
+#pragma endregion //WIEGAND
+
+#pragma region MESSAGE
+
+static void MessageSet(benchmark::State& state)
+{
+    Message message;
+    uint16_t i = 0;
+    for (auto _ : state)
+    {
+        message.set(i, bt_swipes[i % bench_swipes].data, i & 0x07, 0);
+        benchmark::DoNotOptimize(message);
+        i++;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(MessageSet);
+
+#pragma endregion //MESSAGE
+
+#pragma region JSON
+
+#if HOST_BENCH_JSON
+// server answers parsed the same way as parseResponse() of gateway (document of 256 bytes, ids as strings)
+static void ParseResponse(benchmark::State& state)
+{
+    static const char bodies[][64] =
+    {
+        "{\"id\":\"4825841\",\"kod\":\"801\",\"status\":1}",
+        "{\"id\":\"12043218\",\"kod\":\"802\",\"status\":3}",
+        "{\"id\":\"973200870\",\"kod\":\"804\",\"status\":5}",
+        "{\"id\":\"0\",\"kod\":\"0\",\"status\":0}",
+    };
+
+    MemoryStream stream;
+    Message response;
+    uint64_t parsed = 0;
+    for (auto _ : state)
+    {
+        for (const char* body : bodies)
+        {
+            stream.begin((const uint8_t*)body, strlen(body));
+            StaticJsonDocument<256> json;
+            if (!deserializeJson(json, stream))
+            {
+                response.set(
+                    strtoul(json["kod"].as<const char*>(), NULL, 0),
+                    strtoul(json["id"].as<const char*>(), NULL, 0),
+                    json["status"].as<unsigned short>(),
+                    0
+                );
+                parsed++;
+            }
+        }
+    }
+
+    benchmark::DoNotOptimize(response);
+    state.SetItemsProcessed(parsed);
+}
+BENCHMARK(ParseResponse);
+#endif //HOST_BENCH_JSON
+
+#pragma endregion //JSON
+
+BENCHMARK_MAIN();
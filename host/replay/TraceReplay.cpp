@@ -0,0 +1,167 @@
+// replays bus trace (recorded with TRACE_RECORD) through reader firmware built with TRACE_REPLAY on Linux.
+// firmware runs on simulated time: every loop() takes 'tick' microseconds, so replay does not depend on speed of
+// host and the same trace always gives the same output (original timing of trace is kept by TraceStream).
+// records are given one by one on "~>" request, the same way as tools/trace_replay.sh does it with the board.
+// everything firmware prints (debug, '~t' records of transmitted frames) goes to output, requests are dropped.
+//
+//   trace_replay <trace file> [-o output] [--tick us] [--idle ms]
+
+#include <string>
+#include <vector>
+#include <Arduino.h>
+#include <Host.h>
+
+// firmware (main.cpp)
+void setup();
+void loop();
+
+#define replay_tick     100                     // default loop time, us
+#define replay_idle     5000                    // default run after last record, ms
+
+// serial output of firmware: written to temporary file, taken line by line after every loop pass
+struct Output
+{
+    FILE*       serial;
+    FILE*       out;
+    long        scanned = 0;                    // bytes of serial taken
+    std::string line;                           // incomplete line
+    uint32_t    requests = 0;                   // records requested and not given yet
+    uint32_t    sent = 0;                       // '~t' records
+};
+
+static void usage(const char* name)
+{
+    fprintf(stderr, "usage: %s <trace file> [-o output] [--tick us] [--idle ms]\n", name);
+}
+
+// trace records only: other lines of serial log (debug output) are skipped
+static std::vector<std::string> loadTrace(FILE* in)
+{
+    std::vector<std::string> records;
+    char line[256];
+    while (fgets(line, sizeof(line), in))
+    {
+        if (line[0] != '~' || (line[1] != 'r' && line[1] != 't' && line[1] != 'w'))
+            continue;
+
+        std::string record(line);
+        while (!record.empty() && (record.back() == '\n' || record.back() == '\r'))
+            record.pop_back();
+        records.push_back(record + '\n');
+    }
+    return records;
+}
+
+// takes new complete lines of firmware output: counts requests, writes the rest to output
+static void scanOutput(Output& output)
+{
+    fflush(output.serial);
+    fseek(output.serial, output.scanned, SEEK_SET);
+
+    int c;
+    while ((c = fgetc(output.serial)) != EOF)
+    {
+        output.scanned++;
+        if (c == '\r')
+            continue;
+        if (c != '\n')
+        {
+            output.line += (char)c;
+            continue;
+        }
+
+        if (output.line == "~>")
+        {
+            output.requests++;
+        }
+        else
+        {
+            if (output.line.compare(0, 2, "~t") == 0)
+                output.sent++;
+            fprintf(output.out, "%s\n", output.line.c_str());
+        }
+        output.line.clear();
+    }
+    fseek(output.serial, 0, SEEK_END);
+}
+
+int main(int argc, char** argv)
+{
+    const char* trace_path = nullptr;
+    const char* output_path = nullptr;
+    unsigned long tick = replay_tick;
+    unsigned long idle = replay_idle;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc)
+            output_path = argv[++i];
+        else if (arg == "--tick" && i + 1 < argc)
+            tick = strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--idle" && i + 1 < argc)
+            idle = strtoul(argv[++i], nullptr, 10);
+        else if (trace_path == nullptr && arg[0] != '-')
+            trace_path = argv[i];
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (trace_path == nullptr || tick == 0)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    FILE* in = fopen(trace_path, "r");
+    if (in == nullptr)
+    {
+        perror(trace_path);
+        return 1;
+    }
+    std::vector<std::string> records = loadTrace(in);
+    fclose(in);
+
+    Output output;
+    output.out = output_path ? fopen(output_path, "w") : stdout;
+    output.serial = tmpfile();
+    if (output.out == nullptr || output.serial == nullptr)
+    {
+        perror(output_path ? output_path : "tmpfile");
+        return 1;
+    }
+
+    hostSerialOutput(output.serial);
+    setup();
+
+    size_t fed = 0;
+    bool finished = false;
+    unsigned long finish = 0;
+    while (!finished || millis() - finish < idle)
+    {
+        scanOutput(output);
+        for (; output.requests > 0 && fed < records.size(); output.requests--, fed++)
+            hostSerialInput(records[fed].data(), records[fed].size());
+
+        // the last record is consumed: timers of firmware (response timeouts, signals) run out during idle time
+        if (!finished && fed == records.size() && output.requests > 0)
+        {
+            finished = true;
+            finish = millis();
+        }
+
+        loop();
+        hostAdvance(tick);
+    }
+
+    scanOutput(output);
+    fclose(output.serial);
+    if (output.out != stdout)
+        fclose(output.out);
+
+    fprintf(stderr, "records: %u, simulated time: %lu ms, transmitted records: %u\n",
+        (unsigned)records.size(), millis(), output.sent);
+    return 0;
+}
@@ -0,0 +1,318 @@
+#include "Arduino.h"
+#include "Host.h"
+
+volatile uint8_t SREG;
+volatile uint8_t PINB, PINC, PIND, PORTB, PORTC, PORTD, DDRB, DDRC, DDRD;
+volatile uint8_t PCICR, PCIFR, PCMSK0, PCMSK1, PCMSK2, EIMSK;
+volatile uint8_t TCCR0A, TCCR0B, TIMSK0, TIFR0, OCR0A, OCR0B, TCNT0;
+volatile uint8_t TCCR1A, TCCR1B, TIMSK1, TIFR1;
+volatile uint16_t TCNT1;
+volatile uint8_t TCCR2A, TCCR2B, TIMSK2, TIFR2, OCR2A, TCNT2;
+
+HardwareSerial Serial;
+
+static uint64_t host_us = 0;                    // simulated time
+static uint32_t random_state = 1;               // avr-libc random() context
+
+#define port_b          2
+#define port_c          3
+#define port_d          4
+
+#pragma region TIME
+
+unsigned long millis()
+{
+    return (uint32_t)(host_us / 1000);
+}
+
+unsigned long micros()
+{
+    return (uint32_t)host_us;
+}
+
+void delay(unsigned long ms)
+{
+    host_us += (uint64_t)ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    host_us += us;
+}
+
+void hostAdvance(unsigned long us)
+{
+    host_us += us;
+}
+
+#pragma endregion //TIME
+
+#pragma region PINS
+
+uint8_t digitalPinToPort(uint8_t pin)
+{
+    return pin < 8 ? port_d : (pin < 14 ? port_b : port_c);
+}
+
+uint8_t digitalPinToBitMask(uint8_t pin)
+{
+    return _BV(pin < 8 ? pin : (pin < 14 ? pin - 8 : pin - 14));
+}
+
+volatile uint8_t* portInputRegister(uint8_t port)
+{
+    return port == port_b ? &PINB : (port == port_c ? &PINC : &PIND);
+}
+
+volatile uint8_t* portOutputRegister(uint8_t port)
+{
+    return port == port_b ? &PORTB : (port == port_c ? &PORTC : &PORTD);
+}
+
+volatile uint8_t* portModeRegister(uint8_t port)
+{
+    return port == port_b ? &DDRB : (port == port_c ? &DDRC : &DDRD);
+}
+
+volatile uint8_t* digitalPinToPCICR(uint8_t)
+{
+    return &PCICR;
+}
+
+uint8_t digitalPinToPCICRbit(uint8_t pin)
+{
+    return pin < 8 ? PCIE2 : (pin < 14 ? PCIE0 : PCIE1);
+}
+
+volatile uint8_t* digitalPinToPCMSK(uint8_t pin)
+{
+    return pin < 8 ? &PCMSK2 : (pin < 14 ? &PCMSK0 : &PCMSK1);
+}
+
+uint8_t digitalPinToPCMSKbit(uint8_t pin)
+{
+    return pin < 8 ? pin : (pin < 14 ? pin - 8 : pin - 14);
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    uint8_t mask = digitalPinToBitMask(pin);
+    uint8_t port = digitalPinToPort(pin);
+    if (mode == OUTPUT)
+    {
+        *portModeRegister(port) |= mask;
+        return;
+    }
+
+    // nothing is wired: pull-up holds input high
+    *portModeRegister(port) &= ~mask;
+    if (mode == INPUT_PULLUP)
+    {
+        *portOutputRegister(port) |= mask;
+        *portInputRegister(port) |= mask;
+    }
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    uint8_t mask = digitalPinToBitMask(pin);
+    uint8_t port = digitalPinToPort(pin);
+    if (value == LOW)
+        *portOutputRegister(port) &= ~mask;
+    else
+        *portOutputRegister(port) |= mask;
+
+    // output pin reads back what is driven
+    if (*portModeRegister(port) & mask)
+    {
+        if (value == LOW)
+            *portInputRegister(port) &= ~mask;
+        else
+            *portInputRegister(port) |= mask;
+    }
+}
+
+int digitalRead(uint8_t pin)
+{
+    return (*portInputRegister(digitalPinToPort(pin)) & digitalPinToBitMask(pin)) ? HIGH : LOW;
+}
+
+int analogRead(uint8_t)
+{
+    return 0;
+}
+
+void attachInterrupt(uint8_t, void (*)(void), int)
+{
+}
+
+void detachInterrupt(uint8_t)
+{
+}
+
+void hostPin(uint8_t pin, bool high)
+{
+    volatile uint8_t* input = portInputRegister(digitalPinToPort(pin));
+    if (high)
+        *input |= digitalPinToBitMask(pin);
+    else
+        *input &= ~digitalPinToBitMask(pin);
+}
+
+#pragma endregion //PINS
+
+#pragma region RANDOM
+
+// Park-Miller "minimal standard" generator of avr-libc
+static long nextRandom()
+{
+    int32_t x = random_state;
+    if (x == 0)
+        x = 123459876L;
+    int32_t hi = x / 127773L;
+    int32_t lo = x % 127773L;
+    x = 16807L * lo - 2836L * hi;
+    if (x < 0)
+        x += 0x7FFFFFFFL;
+    random_state = x;
+    return x % 0x80000000UL;
+}
+
+long random(long howbig)
+{
+    if (howbig == 0)
+        return 0;
+    return nextRandom() % howbig;
+}
+
+long random(long howsmall, long howbig)
+{
+    if (howsmall >= howbig)
+        return howsmall;
+    return random(howbig - howsmall) + howsmall;
+}
+
+void randomSeed(unsigned long seed)
+{
+    if (seed != 0)
+        random_state = (uint32_t)seed;
+}
+
+#pragma endregion //RANDOM
+
+#pragma region CONVERSION
+
+char* ultoa(unsigned long value, char* buffer, int base)
+{
+    char digits[8 * sizeof(long) + 1];
+    uint8_t count = 0;
+    do
+    {
+        uint8_t c = value % base;
+        value /= base;
+        digits[count++] = c < 10 ? c + '0' : c + 'a' - 10;
+    } while (value);
+
+    for (uint8_t i = 0; i < count; i++)
+        buffer[i] = digits[count - 1 - i];
+    buffer[count] = '\0';
+    return buffer;
+}
+
+char* ltoa(long value, char* buffer, int base)
+{
+    if (base == 10 && value < 0)
+    {
+        buffer[0] = '-';
+        ultoa(-(unsigned long)value, buffer + 1, base);
+        return buffer;
+    }
+    return ultoa((unsigned long)value, buffer, base);
+}
+
+char* utoa(unsigned int value, char* buffer, int base)
+{
+    return ultoa(value, buffer, base);
+}
+
+char* itoa(int value, char* buffer, int base)
+{
+    return ltoa(value, buffer, base);
+}
+
+#pragma endregion //CONVERSION
+
+#pragma region SERIAL
+
+int HardwareSerial::available()
+{
+    return (int)min(_input.size() - _position, (size_t)0x7FFF);
+}
+
+int HardwareSerial::read()
+{
+    if (_position >= _input.size())
+        return -1;
+    return (uint8_t)_input[_position++];
+}
+
+int HardwareSerial::peek()
+{
+    if (_position >= _input.size())
+        return -1;
+    return (uint8_t)_input[_position];
+}
+
+size_t HardwareSerial::write(uint8_t value)
+{
+    FILE* out = _output ? _output : stdout;
+    fputc(value, out);
+    return 1;
+}
+
+void HardwareSerial::flush()
+{
+    fflush(_output ? _output : stdout);
+}
+
+void HardwareSerial::input(const char* data, size_t length)
+{
+    // consumed bytes are dropped, so long replays do not grow the buffer
+    _input.erase(0, _position);
+    _position = 0;
+    _input.append(data, length);
+}
+
+size_t HardwareSerial::pending()
+{
+    return _input.size() - _position;
+}
+
+void HardwareSerial::output(FILE* out)
+{
+    _output = out;
+}
+
+void hostSerialInput(const char* data, size_t length)
+{
+    Serial.input(data, length);
+}
+
+size_t hostSerialPending()
+{
+    return Serial.pending();
+}
+
+void hostSerialOutput(FILE* out)
+{
+    static FILE* null_output = nullptr;
+    if (out == nullptr)
+    {
+        if (null_output == nullptr)
+            null_output = fopen("/dev/null", "w");
+        out = null_output;
+    }
+    Serial.output(out);
+}
+
+#pragma endregion //SERIAL
@@ -0,0 +1,150 @@
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+// minimal Arduino core for building firmware sources on Linux (host benchmarks and trace replay).
+// time is simulated: it passes only in delay() and when harness calls hostAdvance() (Host.h).
+// AVR registers are plain variables, interrupts are never raised by themselves
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <type_traits>
+
+typedef bool            boolean;
+typedef uint8_t         byte;
+typedef unsigned int    word;
+
+#define F_CPU           16000000UL
+
+#define HIGH            1
+#define LOW             0
+#define INPUT           0
+#define OUTPUT          1
+#define INPUT_PULLUP    2
+#define CHANGE          1
+#define FALLING         2
+#define RISING          3
+
+#define DEC             10
+#define HEX             16
+#define OCT             8
+#define BIN             2
+
+#define A0              14
+#define A1              15
+#define A2              16
+#define A3              17
+#define A4              18
+#define A5              19
+#define A6              20
+#define A7              21
+#define LED_BUILTIN     13
+
+// flash is ordinary memory on host
+#define PROGMEM
+#define PSTR(s)                 (s)
+#define F(s)                    (reinterpret_cast<const __FlashStringHelper*>(PSTR(s)))
+#define pgm_read_byte(p)        (*(const uint8_t*)(p))
+#define pgm_read_word(p)        (*(const uint16_t*)(p))
+#define pgm_read_dword(p)       (*(const uint32_t*)(p))
+#define pgm_read_ptr(p)         (*(void* const*)(p))
+#define memcpy_P                memcpy
+#define strlen_P                strlen
+#define strcpy_P                strcpy
+#define strncpy_P               strncpy
+#define strcmp_P                strcmp
+#define sprintf_P               sprintf
+#define snprintf_P              snprintf
+#define vsnprintf_P             vsnprintf
+class __FlashStringHelper;
+
+// registers of ATmega328P used by firmware
+extern volatile uint8_t SREG;
+extern volatile uint8_t PINB, PINC, PIND, PORTB, PORTC, PORTD, DDRB, DDRC, DDRD;
+extern volatile uint8_t PCICR, PCIFR, PCMSK0, PCMSK1, PCMSK2, EIMSK;
+extern volatile uint8_t TCCR0A, TCCR0B, TIMSK0, TIFR0, OCR0A, OCR0B, TCNT0;
+extern volatile uint8_t TCCR1A, TCCR1B, TIMSK1, TIFR1;
+extern volatile uint16_t TCNT1;
+extern volatile uint8_t TCCR2A, TCCR2B, TIMSK2, TIFR2, OCR2A, TCNT2;
+
+#define TOV1            0
+#define TOIE1           0
+#define CS10            0
+#define CS11            1
+#define CS12            2
+#define CS20            0
+#define CS21            1
+#define CS22            2
+#define WGM21           1
+#define OCIE2A          1
+#define OCF2A           1
+#define OCIE0B          2
+#define OCF0B           2
+#define PCIE0           0
+#define PCIE1           1
+#define PCIE2           2
+
+#define ISR_NOBLOCK
+#define ISR(vector, ...)        extern "C" void vector(void)
+#define cli()
+#define sei()
+#define noInterrupts()
+#define interrupts()
+
+#define _BV(b)                  (1 << (b))
+#define bit(b)                  (1UL << (b))
+#define bitRead(v, b)           (((v) >> (b)) & 0x01)
+#define bitSet(v, b)            ((v) |= (1UL << (b)))
+#define bitClear(v, b)          ((v) &= ~(1UL << (b)))
+#define bitWrite(v, b, x)       ((x) ? bitSet(v, b) : bitClear(v, b))
+#define lowByte(w)              ((uint8_t)((w) & 0xFF))
+#define highByte(w)             ((uint8_t)((w) >> 8))
+
+// the same as macros of Arduino core, without evaluating arguments twice (result by value: arguments are copies)
+template <typename A, typename B> inline typename std::common_type<A, B>::type min(A a, B b) { return a < b ? a : b; }
+template <typename A, typename B> inline typename std::common_type<A, B>::type max(A a, B b) { return a > b ? a : b; }
+template <typename V, typename L, typename H> inline V constrain(V v, L low, H high)
+{
+    return v < low ? low : (v > high ? high : v);
+}
+
+// pin mapping of Arduino Nano / Uno (pins 0-7 - port D, 8-13 - port B, A0-A7 - port C)
+uint8_t digitalPinToPort(uint8_t pin);
+uint8_t digitalPinToBitMask(uint8_t pin);
+volatile uint8_t* portInputRegister(uint8_t port);
+volatile uint8_t* portOutputRegister(uint8_t port);
+volatile uint8_t* portModeRegister(uint8_t port);
+volatile uint8_t* digitalPinToPCICR(uint8_t pin);
+uint8_t digitalPinToPCICRbit(uint8_t pin);
+volatile uint8_t* digitalPinToPCMSK(uint8_t pin);
+uint8_t digitalPinToPCMSKbit(uint8_t pin);
+#define digitalPinToInterrupt(p)    ((p) == 2 ? 0 : ((p) == 3 ? 1 : -1))
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void attachInterrupt(uint8_t interrupt, void (*handler)(void), int mode);
+void detachInterrupt(uint8_t interrupt);
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+// avr-libc generator (the same sequence as on board for the same seed)
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+
+char* itoa(int value, char* buffer, int base);
+char* utoa(unsigned int value, char* buffer, int base);
+char* ltoa(long value, char* buffer, int base);
+char* ultoa(unsigned long value, char* buffer, int base);
+
+#include "HardwareSerial.h"
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef DIO2_H
+#define DIO2_H
+
+#include <Arduino.h>
+
+// fast digital i/o of DIO2 library with pin numbers, the same as core functions on host
+typedef uint8_t GPIO_pin_t;
+
+inline void pinMode2(GPIO_pin_t pin, uint8_t mode) { pinMode(pin, mode); }
+inline void digitalWrite2(GPIO_pin_t pin, uint8_t value) { digitalWrite(pin, value); }
+inline uint8_t digitalRead2(GPIO_pin_t pin) { return digitalRead(pin); }
+
+#endif
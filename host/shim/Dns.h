@@ -0,0 +1,20 @@
+#ifndef DNS_H
+#define DNS_H
+
+#include <Arduino.h>
+#include <IPAddress.h>
+
+// resolver of simulated network: host names are dotted addresses only
+class DNSClient
+{
+public:
+    void begin(const IPAddress& server) {}
+
+    // returns 1 if name is resolved
+    int getHostByName(const char* name, IPAddress& address)
+    {
+        return address.fromString(name) ? 1 : 0;
+    }
+};
+
+#endif
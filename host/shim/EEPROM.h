@@ -0,0 +1,41 @@
+#ifndef EEPROM_H
+#define EEPROM_H
+
+#include <Arduino.h>
+
+#define EEPROM_SIZE     1024                    // ATmega328P
+
+// EEPROM of board in RAM (erased: 0xFF), lost when tool exits
+class EEPROMClass
+{
+public:
+    uint8_t read(int address) { return _data[address]; }
+    void write(int address, uint8_t value) { _data[address] = value; }
+    void update(int address, uint8_t value) { _data[address] = value; }
+    uint16_t length() { return EEPROM_SIZE; }
+    uint8_t& operator[](int address) { return _data[address]; }
+
+    template <typename T> T& get(int address, T& value)
+    {
+        memcpy(&value, &_data[address], sizeof(T));
+        return value;
+    }
+
+    template <typename T> const T& put(int address, const T& value)
+    {
+        memcpy(&_data[address], &value, sizeof(T));
+        return value;
+    }
+
+    // harness: erased chip
+    void clear() { memset(_data, 0xFF, sizeof(_data)); }
+
+    EEPROMClass() { clear(); }
+
+private:
+    uint8_t     _data[EEPROM_SIZE];
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
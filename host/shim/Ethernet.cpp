@@ -0,0 +1,175 @@
+#include "Ethernet.h"
+#include "Host.h"
+#include "SPI.h"
+#include <deque>
+#include <vector>
+
+EthernetClass Ethernet;
+SPIClass SPI;
+
+struct Datagram
+{
+    IPAddress               ip;                 // source of received, target of sent datagram
+    uint16_t                port;               // source port of received, target port of sent datagram
+    uint16_t                local_port;         // port of board
+    std::vector<uint8_t>    data;
+};
+
+static std::deque<Datagram> received;           // waiting for parsePacket() of socket
+static std::deque<Datagram> sent;               // waiting for harness
+static std::string (*http_server)(const std::string& request) = nullptr;
+
+uint8_t EthernetUDP::begin(uint16_t port)
+{
+    _port = port;
+    _received_length = _position = 0;
+    return 1;
+}
+
+void EthernetUDP::stop()
+{
+    _port = 0;
+    _received_length = _position = 0;
+}
+
+int EthernetUDP::beginPacket(IPAddress ip, uint16_t port)
+{
+    _target_ip = ip;
+    _target_port = port;
+    _sending_length = 0;
+    return 1;
+}
+
+size_t EthernetUDP::write(const uint8_t* data, size_t length)
+{
+    length = min(length, sizeof(_sending) - _sending_length);
+    memcpy(_sending + _sending_length, data, length);
+    _sending_length += length;
+    return length;
+}
+
+int EthernetUDP::endPacket()
+{
+    Datagram d;
+    d.ip = _target_ip;
+    d.port = _target_port;
+    d.local_port = _port;
+    d.data.assign(_sending, _sending + _sending_length);
+    sent.push_back(d);
+    return 1;
+}
+
+int EthernetUDP::parsePacket()
+{
+    _received_length = _position = 0;
+    if (_port == 0)
+        return 0;
+
+    for (auto d = received.begin(); d != received.end(); ++d)
+    {
+        if (d->local_port != _port)
+            continue;
+        _remote_ip = d->ip;
+        _remote_port = d->port;
+        _received_length = min(d->data.size(), sizeof(_received));
+        memcpy(_received, d->data.data(), _received_length);
+        received.erase(d);
+        return (int)_received_length;
+    }
+    return 0;
+}
+
+int EthernetUDP::read()
+{
+    return _position < _received_length ? _received[_position++] : -1;
+}
+
+int EthernetUDP::read(unsigned char* data, size_t length)
+{
+    length = min(length, _received_length - _position);
+    memcpy(data, _received + _position, length);
+    _position += length;
+    return (int)length;
+}
+
+int EthernetClient::connect(IPAddress ip, uint16_t port)
+{
+    stop();
+    _open = http_server != nullptr;
+    return _open;
+}
+
+int EthernetClient::connect(const char* host, uint16_t port)
+{
+    return connect(IPAddress(), port);
+}
+
+void EthernetClient::stop()
+{
+    _open = false;
+    _request.clear();
+    _response.clear();
+    _position = 0;
+}
+
+size_t EthernetClient::write(const uint8_t* data, size_t length)
+{
+    if (!_open)
+        return 0;
+
+    _request.append((const char*)data, length);
+    if (_response.empty() && _request.find("\r\n\r\n") != std::string::npos)
+        _response = http_server(_request);
+    return length;
+}
+
+int EthernetClient::available()
+{
+    return (int)(_response.size() - _position);
+}
+
+int EthernetClient::read()
+{
+    return _position < _response.size() ? (uint8_t)_response[_position++] : -1;
+}
+
+int EthernetClient::peek()
+{
+    return _position < _response.size() ? (uint8_t)_response[_position] : -1;
+}
+
+void hostHttpServer(std::string (*server)(const std::string& request))
+{
+    http_server = server;
+}
+
+void hostLocalIP(IPAddress ip)
+{
+    Ethernet._local_ip = ip;
+}
+
+void hostUdpInput(uint16_t port, IPAddress from, uint16_t from_port, const uint8_t* data, size_t length)
+{
+    Datagram d;
+    d.ip = from;
+    d.port = from_port;
+    d.local_port = port;
+    d.data.assign(data, data + length);
+    received.push_back(d);
+}
+
+int hostUdpSent(uint8_t* data, size_t size, IPAddress* to, uint16_t* port)
+{
+    if (sent.empty())
+        return -1;
+
+    Datagram d = sent.front();
+    sent.pop_front();
+    if (to)
+        *to = d.ip;
+    if (port)
+        *port = d.port;
+    size_t length = min(d.data.size(), size);
+    memcpy(data, d.data.data(), length);
+    return (int)length;
+}
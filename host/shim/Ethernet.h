@@ -0,0 +1,58 @@
+#ifndef ETHERNET_H
+#define ETHERNET_H
+
+#include <string>
+#include <Arduino.h>
+#include <IPAddress.h>
+#include <EthernetUdp.h>
+
+#define MAX_SOCK_NUM    4                       // sockets of W5100
+
+enum EthernetLinkStatus { Unknown, LinkON, LinkOFF };
+enum EthernetHardwareStatus { EthernetNoHardware, EthernetW5100, EthernetW5200, EthernetW5500 };
+
+// W5x00 of simulated board: link is always on, DHCP gives hostLocalIP() address
+class EthernetClass
+{
+public:
+    int begin(uint8_t* mac, unsigned long timeout = 60000, unsigned long response_timeout = 4000) { return 1; }
+    int maintain() { return 0; }
+    EthernetLinkStatus linkStatus() { return LinkON; }
+    EthernetHardwareStatus hardwareStatus() { return EthernetW5500; }
+    IPAddress localIP() { return _local_ip; }
+    IPAddress dnsServerIP() { return IPAddress(); }
+
+    // harness
+    IPAddress   _local_ip;
+};
+
+extern EthernetClass Ethernet;
+
+// TCP connection to simulated http server (hostHttpServer): request written by firmware is answered as soon as
+// its headers are complete. without server connect fails
+class EthernetClient : public Stream
+{
+public:
+    int connect(IPAddress ip, uint16_t port);
+    int connect(const char* host, uint16_t port);
+    uint8_t connected() { return _open || available() > 0; }
+    operator bool() { return _open; }
+    void stop();
+    void setConnectionTimeout(uint16_t timeout) {}
+    uint8_t getSocketNumber() const { return 0; }
+
+    int available();
+    int read();
+    int peek();
+    size_t write(uint8_t value) { return write(&value, 1); }
+    size_t write(const uint8_t* data, size_t length);
+    using Print::write;
+
+private:
+    bool        _open = false;
+    std::string _request;
+    std::string _response;
+    size_t      _position = 0;
+};
+
+#endif
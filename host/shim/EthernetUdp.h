@@ -0,0 +1,43 @@
+#ifndef ETHERNET_UDP_H
+#define ETHERNET_UDP_H
+
+#include <Arduino.h>
+#include <IPAddress.h>
+
+// udp socket on simulated network: datagrams come from harness (hostUdpInput), sent ones go to it (hostUdpSent)
+class EthernetUDP
+{
+public:
+    uint8_t begin(uint16_t port);
+    uint8_t beginMulticast(IPAddress group, uint16_t port) { return begin(port); }
+    void stop();
+
+    int beginPacket(IPAddress ip, uint16_t port);
+    size_t write(uint8_t value) { return write(&value, 1); }
+    size_t write(const uint8_t* data, size_t length);
+    int endPacket();
+
+    // takes next datagram to port of socket. returns its size (0 - none)
+    int parsePacket();
+    int available() { return (int)(_received_length - _position); }
+    int read();
+    int read(unsigned char* data, size_t length);
+    int read(char* data, size_t length) { return read((unsigned char*)data, length); }
+    void flush() { _position = _received_length; }
+    IPAddress remoteIP() { return _remote_ip; }
+    uint16_t remotePort() { return _remote_port; }
+
+private:
+    uint16_t    _port = 0;                      // 0 - closed
+    IPAddress   _remote_ip;
+    uint16_t    _remote_port = 0;
+    uint8_t     _received[1500];
+    size_t      _received_length = 0;
+    size_t      _position = 0;
+    IPAddress   _target_ip;
+    uint16_t    _target_port = 0;
+    uint8_t     _sending[1500];
+    size_t      _sending_length = 0;
+};
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef HARDWARE_SERIAL_H
+#define HARDWARE_SERIAL_H
+
+#include <stdio.h>
+#include <string>
+#include "Stream.h"
+
+// serial port of board: input is given by harness (hostSerialInput), output goes to file (stdout by default)
+class HardwareSerial : public Stream
+{
+public:
+    void begin(unsigned long) {}
+    void end() {}
+    operator bool() { return true; }
+
+    int available();
+    int read();
+    int peek();
+    size_t write(uint8_t value);
+    using Print::write;
+    void flush();
+
+    // harness side (Host.h)
+    void input(const char* data, size_t length);
+    size_t pending();
+    void output(FILE* out);
+
+private:
+    std::string _input;
+    size_t      _position = 0;
+    FILE*       _output = nullptr;
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef HOST_H
+#define HOST_H
+
+#include <Arduino.h>
+#include <string>
+#include <IPAddress.h>
+
+// control of simulated board for host tools (not a part of Arduino core)
+
+// simulated time passes (delay() of firmware advances it too)
+void hostAdvance(unsigned long us);
+
+// bytes coming to Serial of board (appended to unread ones)
+void hostSerialInput(const char* data, size_t length);
+
+// unread bytes of Serial input
+size_t hostSerialPending();
+
+// where Serial output of board goes (stdout by default, nullptr - nowhere)
+void hostSerialOutput(FILE* out);
+
+// set level of input pin as wired outside (pin change interrupts are not raised, harness calls ISR itself)
+void hostPin(uint8_t pin, bool high);
+
+// http server of simulated network: answer (with headers) to request of EthernetClient (nullptr - server is down)
+void hostHttpServer(std::string (*server)(const std::string& request));
+
+// address of board on simulated network (Ethernet.localIP())
+void hostLocalIP(IPAddress ip);
+
+// datagram comes to udp port of board
+void hostUdpInput(uint16_t port, IPAddress from, uint16_t from_port, const uint8_t* data, size_t length);
+
+// takes the oldest datagram board sent. returns its length (-1 - none)
+int hostUdpSent(uint8_t* data, size_t size, IPAddress* to = nullptr, uint16_t* port = nullptr);
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef IP_ADDRESS_H
+#define IP_ADDRESS_H
+
+#include <Arduino.h>
+
+// IPv4 address of Arduino Ethernet library
+class IPAddress
+{
+public:
+    IPAddress() : IPAddress(0, 0, 0, 0) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) { _bytes[0] = a; _bytes[1] = b; _bytes[2] = c; _bytes[3] = d; }
+    IPAddress(uint32_t address) { memcpy(_bytes, &address, sizeof(_bytes)); }
+
+    // dotted address. returns false if text is not one
+    bool fromString(const char* text)
+    {
+        unsigned a, b, c, d;
+        char tail;
+        if (sscanf(text, "%u.%u.%u.%u%c", &a, &b, &c, &d, &tail) != 4 || a > 255 || b > 255 || c > 255 || d > 255)
+            return false;
+        *this = IPAddress(a, b, c, d);
+        return true;
+    }
+
+    operator uint32_t() const { uint32_t a; memcpy(&a, _bytes, sizeof(a)); return a; }
+    uint8_t operator[](int index) const { return _bytes[index]; }
+    uint8_t& operator[](int index) { return _bytes[index]; }
+    bool operator==(const IPAddress& other) const { return memcmp(_bytes, other._bytes, sizeof(_bytes)) == 0; }
+    bool operator!=(const IPAddress& other) const { return !(*this == other); }
+
+private:
+    uint8_t     _bytes[4];
+};
+
+#endif
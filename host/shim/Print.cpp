@@ -0,0 +1,141 @@
+#include "Print.h"
+#include <stdio.h>
+#include <string.h>
+
+size_t Print::write(const uint8_t* buffer, size_t size)
+{
+    size_t written = 0;
+    while (size--)
+    {
+        if (write(*buffer++) == 0)
+            break;
+        written++;
+    }
+    return written;
+}
+
+size_t Print::write(const char* text)
+{
+    return text == nullptr ? 0 : write((const uint8_t*)text, strlen(text));
+}
+
+size_t Print::print(const __FlashStringHelper* text)
+{
+    return write(reinterpret_cast<const char*>(text));
+}
+
+size_t Print::print(const char* text)
+{
+    return write(text);
+}
+
+size_t Print::print(char value)
+{
+    return write((uint8_t)value);
+}
+
+size_t Print::print(unsigned char value, int base)
+{
+    return print((unsigned long)value, base);
+}
+
+size_t Print::print(int value, int base)
+{
+    return print((long)value, base);
+}
+
+size_t Print::print(unsigned int value, int base)
+{
+    return print((unsigned long)value, base);
+}
+
+size_t Print::print(long value, int base)
+{
+    if (base == 0)
+        return write((uint8_t)value);
+    if (base == 10 && value < 0)
+        return print('-') + printNumber(-(unsigned long)value, 10);
+    return printNumber(value, base);
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+    if (base == 0)
+        return write((uint8_t)value);
+    return printNumber(value, base);
+}
+
+size_t Print::print(double value, int digits)
+{
+    char text[48];
+    snprintf(text, sizeof(text), "%.*f", digits, value);
+    return write(text);
+}
+
+size_t Print::println()
+{
+    return write("\r\n");
+}
+
+size_t Print::println(const __FlashStringHelper* text)
+{
+    return print(text) + println();
+}
+
+size_t Print::println(const char* text)
+{
+    return print(text) + println();
+}
+
+size_t Print::println(char value)
+{
+    return print(value) + println();
+}
+
+size_t Print::println(unsigned char value, int base)
+{
+    return print(value, base) + println();
+}
+
+size_t Print::println(int value, int base)
+{
+    return print(value, base) + println();
+}
+
+size_t Print::println(unsigned int value, int base)
+{
+    return print(value, base) + println();
+}
+
+size_t Print::println(long value, int base)
+{
+    return print(value, base) + println();
+}
+
+size_t Print::println(unsigned long value, int base)
+{
+    return print(value, base) + println();
+}
+
+size_t Print::println(double value, int digits)
+{
+    return print(value, digits) + println();
+}
+
+size_t Print::printNumber(unsigned long value, uint8_t base)
+{
+    char text[8 * sizeof(long) + 1];
+    char* digit = &text[sizeof(text) - 1];
+    *digit = '\0';
+
+    if (base < 2)
+        base = 10;
+    do
+    {
+        char c = value % base;
+        value /= base;
+        *--digit = c < 10 ? c + '0' : c + 'A' - 10;
+    } while (value);
+
+    return write(digit);
+}
@@ -0,0 +1,26 @@
+#ifndef SPI_H
+#define SPI_H
+
+#include <Arduino.h>
+
+#define MSBFIRST        1
+#define SPI_MODE0       0
+
+struct SPISettings
+{
+    SPISettings(uint32_t, uint8_t, uint8_t) {}
+};
+
+// SPI bus without devices: every transfer reads 0xFF (no chip answers)
+class SPIClass
+{
+public:
+    void begin() {}
+    void beginTransaction(SPISettings) {}
+    uint8_t transfer(uint8_t) { return 0xFF; }
+    void endTransaction() {}
+};
+
+extern SPIClass SPI;
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef SOFTWARE_SERIAL_H
+#define SOFTWARE_SERIAL_H
+
+#include <string>
+#include <Arduino.h>
+
+// software serial of RS485 bus without line: received bytes are given by harness, sent ones are kept for it
+class SoftwareSerial : public Stream
+{
+public:
+    SoftwareSerial(uint8_t rx_pin, uint8_t tx_pin) : _rx_pin(rx_pin), _tx_pin(tx_pin) {}
+
+    void begin(long) {}
+    bool listen() { return false; }
+    bool isListening() { return true; }
+
+    int available() { return (int)(_received.size() - _position); }
+    int read() { return _position < _received.size() ? (uint8_t)_received[_position++] : -1; }
+    int peek() { return _position < _received.size() ? (uint8_t)_received[_position] : -1; }
+    size_t write(uint8_t value) { _sent.push_back((char)value); return 1; }
+    using Print::write;
+
+    // harness side: bytes from line, bytes sent to line since last take
+    void receive(const uint8_t* data, size_t length)
+    {
+        _received.erase(0, _position);
+        _position = 0;
+        _received.append((const char*)data, length);
+    }
+
+    std::string take()
+    {
+        std::string sent;
+        sent.swap(_sent);
+        return sent;
+    }
+
+private:
+    uint8_t     _rx_pin;
+    uint8_t     _tx_pin;
+    std::string _received;
+    size_t      _position = 0;
+    std::string _sent;
+};
+
+#endif
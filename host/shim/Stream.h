@@ -0,0 +1,32 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include "Print.h"
+
+// byte stream of Arduino core. waiting functions (find, readBytes) spend simulated time in delay()
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeout) { _timeout = timeout; }
+    unsigned long getTimeout() { return _timeout; }
+
+    bool find(const char* target);
+    bool find(const char* target, size_t length);
+    bool find(char target) { return find(&target, 1); }
+
+    size_t readBytes(char* buffer, size_t length);
+    size_t readBytes(uint8_t* buffer, size_t length) { return readBytes((char*)buffer, length); }
+    size_t readBytesUntil(char terminator, char* buffer, size_t length);
+
+protected:
+    // read with timeout, -1 if nothing came
+    int timedRead();
+
+    unsigned long _timeout = 1000;
+};
+
+#endif
@@ -0,0 +1,411 @@
+// runs real reader firmware image (PlatformIO build with PROFILE on) under simavr and collects its "prof" reports:
+// AVR cycles of hot paths, the same numbers as on the board. harness plays the outside world with exact timing:
+// wiegand swipes on both heads (D0/D1 pulses of 50 us every 2 ms), master answers on RS485 rx pin.
+// RS485 bytes are bit-banged on rx pin at 9600 baud (NeoSWSerial samples it itself).
+// gateway image is not supported: W5100 is not simulated and the firmware waits for ethernet link in setup().
+// mean cycles of all reports are compared with baselines of firmware, '--update main.cpp' writes them as new baselines.
+//
+//   sim_bench <firmware.elf> [--seconds s] [--tolerance %] [--update main.cpp] [-v]
+//   sim_bench ArduinoNanoReader/.pio/build/nanoatmega328/firmware.elf --update ArduinoNanoReader/src/main.cpp
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <sim_avr.h>
+#include <sim_elf.h>
+#include <sim_irq.h>
+#include <sim_cycle_timers.h>
+#include <avr_ioport.h>
+#include <avr_uart.h>
+
+#define sim_mcu         "atmega328p"            // Arduino Nano and Uno
+#define sim_frequency   16000000UL
+#define sim_seconds     25                      // two report periods (prof_period) and a bit
+#define sim_tolerance   10                      // the same as prof_tolerance
+#define sim_start_us    1500000UL               // first swipe / lookup (setup and registration are done)
+#define sim_period_us   2000000UL               // one swipe / lookup every period (w_delay is 1 s)
+
+#define rs_baud         9600
+#define rs_device       3212                    // device id of first reader head (head_id(0) of main.cpp)
+#define w_bit_us        2000                    // wiegand bit period
+#define w_pulse_us      50                      // wiegand pulse width
+#define w_answer_us     80000                   // master answer after swipe
+
+// level change of input pin at given cycle
+struct Edge
+{
+    avr_cycle_count_t cycle;
+    avr_irq_t*  pin;
+    uint8_t     level;
+};
+
+// edges of whole run (sorted), fired by cycle timer one by one
+struct Scenario
+{
+    std::vector<Edge> edges;
+    size_t      next = 0;
+};
+
+// statistics of one slot over all reports
+struct Stat
+{
+    uint64_t    count = 0;
+    uint64_t    total = 0;                      // sum of avg * n
+    uint32_t    base = 0;
+};
+
+// firmware serial output parsed line by line
+struct Report
+{
+    std::string line;
+    std::vector<std::string> order;             // slot names as they come
+    std::map<std::string, Stat> stats;
+    uint32_t    reports = 0;
+    bool        verbose = false;
+};
+
+static void usage(const char* name)
+{
+    fprintf(stderr, "usage: %s <firmware.elf> [--seconds s] [--tolerance %%] [--update main.cpp] [-v]\n", name);
+}
+
+#pragma region SCENARIO
+
+static avr_cycle_count_t usToCycles(uint64_t us)
+{
+    return us * (sim_frequency / 1000000UL);
+}
+
+static void addEdge(Scenario& scenario, avr_cycle_count_t cycle, avr_irq_t* pin, uint8_t level)
+{
+    scenario.edges.push_back(Edge{ cycle, pin, level });
+}
+
+// 26 bit frame: even parity of first 12 data bits, 24 data bits (msb first), odd parity of last 12 bits
+static void addSwipe(Scenario& scenario, uint64_t us, avr_irq_t* d0, avr_irq_t* d1, uint32_t code)
+{
+    uint8_t bits[26];
+    uint8_t even = 0;
+    uint8_t odd = 1;
+    for (uint8_t i = 0; i < 24; i++)
+    {
+        bits[i + 1] = (code >> (23 - i)) & 1;
+        if (i < 12)
+            even ^= bits[i + 1];
+        else
+            odd ^= bits[i + 1];
+    }
+    bits[0] = even;
+    bits[25] = odd;
+
+    for (uint8_t i = 0; i < 26; i++)
+    {
+        avr_irq_t* pin = bits[i] ? d1 : d0;
+        addEdge(scenario, usToCycles(us + i * w_bit_us), pin, 0);
+        addEdge(scenario, usToCycles(us + i * w_bit_us + w_pulse_us), pin, 1);
+    }
+}
+
+// 8N1 bytes back to back, line is idle high
+static void addBytes(Scenario& scenario, uint64_t us, avr_irq_t* rx, const uint8_t* bytes, uint8_t length)
+{
+    double bit = (double)sim_frequency / rs_baud;
+    double cycle = usToCycles(us);
+    for (uint8_t i = 0; i < length; i++)
+    {
+        uint16_t frame = (uint16_t)(bytes[i] << 1) | 0x200;    // start bit 0, data lsb first, stop bit 1
+        uint8_t level = 1;
+        for (uint8_t b = 0; b < 10; b++)
+        {
+            uint8_t bit_level = (frame >> b) & 1;
+            if (bit_level != level)
+                addEdge(scenario, (avr_cycle_count_t)cycle, rx, bit_level);
+            level = bit_level;
+            cycle += bit;
+        }
+    }
+}
+
+// bus frame of Channel: header, size, Message (little-endian, packed), xor checksum
+static void addFrame(Scenario& scenario, uint64_t us, avr_irq_t* rx,
+    uint16_t device_id, uint32_t card_id, uint16_t state_id, uint16_t other_id)
+{
+    uint8_t frame[14] = { 0x06, 0x85, 10 };
+    uint8_t message[10] =
+    {
+        (uint8_t)device_id, (uint8_t)(device_id >> 8),
+        (uint8_t)card_id, (uint8_t)(card_id >> 8), (uint8_t)(card_id >> 16), (uint8_t)(card_id >> 24),
+        (uint8_t)state_id, (uint8_t)(state_id >> 8),
+        (uint8_t)other_id, (uint8_t)(other_id >> 8)
+    };
+    uint8_t checksum = 10;
+    for (uint8_t i = 0; i < 10; i++)
+    {
+        frame[3 + i] = message[i];
+        checksum ^= message[i];
+    }
+    frame[13] = checksum;
+    addBytes(scenario, us, rx, frame, sizeof(frame));
+}
+
+// the same conversion as wiegandToDecimal() of reader (byte order of code reversed)
+static uint32_t toDecimal(uint32_t code)
+{
+    uint32_t decimal = 0;
+    while (code > 0)
+    {
+        decimal = decimal * 256 + code % 256;
+        code /= 256;
+    }
+    return decimal;
+}
+
+// reader: swipes on heads by turn (head 0 - pins 2/3, head 1 - A0/A1), master allows every card
+static void buildReader(avr_t* avr, Scenario& scenario, uint32_t seconds)
+{
+    avr_irq_t* d0[2] = { avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('D'), 2), avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('C'), 0) };
+    avr_irq_t* d1[2] = { avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('D'), 3), avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('C'), 1) };
+    avr_irq_t* rx = avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('D'), 4);
+
+    // idle lines: data pins and rx high, door closed (reed pin 12 low), exit button released (A2 high), case shut (A3 low)
+    for (uint8_t h = 0; h < 2; h++)
+    {
+        addEdge(scenario, 0, d0[h], 1);
+        addEdge(scenario, 0, d1[h], 1);
+    }
+    addEdge(scenario, 0, rx, 1);
+    addEdge(scenario, 0, avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('B'), 4), 0);
+    addEdge(scenario, 0, avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('C'), 2), 1);
+    addEdge(scenario, 0, avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('C'), 3), 0);
+
+    uint32_t code = 0x2A4E31;
+    uint8_t head = 0;
+    for (uint64_t us = sim_start_us; us + sim_period_us <= seconds * 1000000ULL; us += sim_period_us)
+    {
+        addSwipe(scenario, us, d0[head], d1[head], code);
+        addFrame(scenario, us + 26 * w_bit_us + w_answer_us, rx, rs_device + head, toDecimal(code), 1, 0);
+        code = (code * 1103515245 + 12345) & 0xFFFFFF;
+        head ^= 1;
+    }
+}
+
+static avr_cycle_count_t fireEdges(avr_t* avr, avr_cycle_count_t when, void* param)
+{
+    Scenario& scenario = *(Scenario*)param;
+    while (scenario.next < scenario.edges.size() && scenario.edges[scenario.next].cycle <= when)
+    {
+        const Edge& edge = scenario.edges[scenario.next++];
+        avr_raise_irq(edge.pin, edge.level);
+    }
+    return scenario.next < scenario.edges.size() ? scenario.edges[scenario.next].cycle : 0;
+}
+
+#pragma endregion //SCENARIO
+
+#pragma region REPORT
+
+// prof\t<name>\tn=<count>\tmin=<cycles>\tavg=<cycles>\tmax=<cycles>\tbase=<cycles>\t<verdict>
+static void parseLine(Report& report, const std::string& line)
+{
+    if (report.verbose)
+        printf("%s\n", line.c_str());
+    if (line.compare(0, 5, "prof\t") != 0)
+        return;
+
+    std::vector<std::string> fields;
+    std::stringstream stream(line);
+    std::string field;
+    while (std::getline(stream, field, '\t'))
+        fields.push_back(field);
+    if (fields.size() < 8)
+        return;
+
+    const std::string& name = fields[1];
+    uint32_t count = strtoul(fields[2].c_str() + 2, nullptr, 10);
+    uint32_t avg = strtoul(fields[4].c_str() + 4, nullptr, 10);
+    uint32_t base = strtoul(fields[6].c_str() + 5, nullptr, 10);
+
+    if (report.stats.find(name) == report.stats.end())
+        report.order.push_back(name);
+    Stat& stat = report.stats[name];
+    stat.count += count;
+    stat.total += (uint64_t)avg * count;
+    stat.base = base;
+    if (name == report.order.front())
+        report.reports++;
+}
+
+static void uartByte(avr_irq_t* irq, uint32_t value, void* param)
+{
+    Report& report = *(Report*)param;
+    char c = (char)value;
+    if (c == '\r')
+        return;
+    if (c != '\n')
+    {
+        report.line += c;
+        return;
+    }
+    parseLine(report, report.line);
+    report.line.clear();
+}
+
+// replaces values of prof_baselines in main.cpp, slot index is taken from p_name_<index> with the same name
+static bool updateBaselines(const char* path, const Report& report)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        perror(path);
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    std::string source = buffer.str();
+    in.close();
+
+    std::regex baselines_regex("(prof_baselines\\[p_count\\] PROGMEM = \\{)([^}]*)(\\};)");
+    std::smatch baselines_match;
+    if (!std::regex_search(source, baselines_match, baselines_regex))
+    {
+        fprintf(stderr, "%s: prof_baselines not found\n", path);
+        return false;
+    }
+
+    std::vector<std::string> values;
+    std::stringstream old_values(baselines_match[2].str());
+    std::string value;
+    while (std::getline(old_values, value, ','))
+        values.push_back(std::to_string(strtoul(value.c_str(), nullptr, 0)));
+
+    std::regex name_regex("p_name_([0-9]+)\\[\\] PROGMEM = \"([^\"]*)\"");
+    for (std::sregex_iterator i(source.begin(), source.end(), name_regex), end; i != end; ++i)
+    {
+        size_t index = std::stoul((*i)[1].str());
+        auto stat = report.stats.find((*i)[2].str());
+        if (index < values.size() && stat != report.stats.end() && stat->second.count > 0)
+            values[index] = std::to_string(stat->second.total / stat->second.count);
+    }
+
+    std::string joined = " ";
+    for (size_t i = 0; i < values.size(); i++)
+        joined += values[i] + (i + 1 < values.size() ? ", " : " ");
+    source = baselines_match.prefix().str() + baselines_match[1].str() + joined + baselines_match[3].str()
+        + baselines_match.suffix().str();
+
+    std::ofstream out(path);
+    out << source;
+    return (bool)out;
+}
+
+#pragma endregion //REPORT
+
+int main(int argc, char** argv)
+{
+    const char* elf_path = nullptr;
+    const char* update_path = nullptr;
+    uint32_t seconds = sim_seconds;
+    uint32_t tolerance = sim_tolerance;
+    Report report;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--seconds" && i + 1 < argc)
+            seconds = strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--tolerance" && i + 1 < argc)
+            tolerance = strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--update" && i + 1 < argc)
+            update_path = argv[++i];
+        else if (arg == "-v")
+            report.verbose = true;
+        else if (elf_path == nullptr && arg[0] != '-')
+            elf_path = argv[i];
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (elf_path == nullptr || seconds == 0)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    elf_firmware_t firmware = {};
+    if (elf_read_firmware(elf_path, &firmware) != 0)
+    {
+        fprintf(stderr, "%s: can't read firmware\n", elf_path);
+        return 1;
+    }
+    avr_t* avr = avr_make_mcu_by_name(firmware.mmcu[0] ? firmware.mmcu : sim_mcu);
+    if (avr == nullptr)
+    {
+        fprintf(stderr, "%s: unknown mcu\n", firmware.mmcu[0] ? firmware.mmcu : sim_mcu);
+        return 1;
+    }
+    avr_init(avr);
+    avr_load_firmware(avr, &firmware);
+    avr->frequency = firmware.frequency ? firmware.frequency : sim_frequency;
+
+    // serial output goes to harness only
+    uint32_t flags = 0;
+    avr_ioctl(avr, AVR_IOCTL_UART_GET_FLAGS('0'), &flags);
+    flags &= ~AVR_UART_FLAG_STDIO;
+    avr_ioctl(avr, AVR_IOCTL_UART_SET_FLAGS('0'), &flags);
+    avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_OUTPUT), uartByte, &report);
+
+    Scenario scenario;
+    buildReader(avr, scenario, seconds);
+    std::stable_sort(scenario.edges.begin(), scenario.edges.end(),
+        [](const Edge& a, const Edge& b) { return a.cycle < b.cycle; });
+    avr_cycle_timer_register(avr, 1, fireEdges, &scenario);
+
+    avr_cycle_count_t end = usToCycles((uint64_t)seconds * 1000000ULL);
+    int state = cpu_Running;
+    while (state != cpu_Done && state != cpu_Crashed && avr->cycle < end)
+        state = avr_run(avr);
+
+    if (state == cpu_Crashed)
+        fprintf(stderr, "firmware crashed at %.3f s\n", (double)avr->cycle / avr->frequency);
+    if (report.order.empty())
+    {
+        fprintf(stderr, "no prof reports in %u s: firmware has to be built with PROFILE\n", seconds);
+        return 1;
+    }
+
+    // mean of all reports against baseline of firmware (the same check as Profiler::report())
+    bool slow = false;
+    printf("%-28s %10s %10s %10s\n", "slot", "samples", "mean", "base");
+    for (const std::string& name : report.order)
+    {
+        const Stat& stat = report.stats[name];
+        uint32_t mean = stat.count ? stat.total / stat.count : 0;
+        const char* verdict = "-";
+        if (stat.base != 0)
+        {
+            bool over = mean > stat.base + (uint64_t)stat.base * tolerance / 100;
+            verdict = over ? "SLOW" : "ok";
+            slow = slow || over;
+        }
+        printf("%-28s %10llu %10u %10u  %s\n", name.c_str(), (unsigned long long)stat.count, mean, stat.base, verdict);
+    }
+    printf("reports: %u, simulated: %u s\n", report.reports, seconds);
+
+    if (update_path)
+    {
+        if (!updateBaselines(update_path, report))
+            return 1;
+        printf("baselines written to %s\n", update_path);
+    }
+    return slow ? 2 : 0;
+}
@@ -0,0 +1,121 @@
+// decisions of peer gateways: only signed negative ones reach decision cache, for no longer than local ttl
+
+#include <gtest/gtest.h>
+
+#include <Arduino.h>
+#include <Host.h>
+#include <Cluster.h>
+#include <DecisionCache.h>
+#include <SipHash.h>
+
+namespace
+{
+
+const uint8_t key[SIPHASH_KEY] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+const uint8_t other_key[SIPHASH_KEY] = { 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1 };
+
+#define port            8586
+#define ttl_max         300
+#define st_allow        1
+#define st_denied       3
+#define st_invalid      4
+#define st_blocked      5
+
+const IPAddress group(239, 1, 85, 85);
+const IPAddress local(10, 0, 0, 2);
+const IPAddress peer(10, 0, 0, 3);
+
+class ClusterTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        hostLocalIP(local);
+        uint8_t data[64];
+        ASSERT_TRUE(cluster.begin(group, port, key, &cache, ttl_max, (1 << st_denied) | (1 << st_invalid) | (1 << st_blocked)));
+        while (hostUdpSent(data, sizeof(data)) >= 0)
+            ;
+    }
+
+    // message of peer gateway signed with given key
+    void receive(uint8_t type, uint16_t device_id, uint32_t card_id, uint16_t state_id, uint16_t ttl, const uint8_t* signer = key)
+    {
+        Cluster::Packet packet;
+        packet.magic = CLUSTER_MAGIC;
+        packet.type = type;
+        packet.ttl = ttl;
+        packet.device_id = device_id;
+        packet.card_id = card_id;
+        packet.state_id = state_id;
+        SipHash::sign(signer, (const uint8_t*)&packet, offsetof(Cluster::Packet, mac), packet.mac);
+        hostUdpInput(port, peer, port, (const uint8_t*)&packet, sizeof(packet));
+
+        Cluster::Packet passage;
+        while (cluster.update(passage))
+            ;
+    }
+
+    bool cached(uint16_t device_id, uint32_t card_id, uint16_t& state_id)
+    {
+        return cache.get(device_id, card_id, state_id);
+    }
+
+    Cluster         cluster;
+    DecisionCache   cache;
+};
+
+}
+
+// peer can not let card in: allow is not put to cache
+TEST_F(ClusterTest, PeerAllowIgnored)
+{
+    uint16_t state_id;
+    receive(Cluster::m_entry, 801, 4825841, st_allow, 60);
+    EXPECT_FALSE(cached(801, 4825841, state_id));
+    EXPECT_EQ(cluster.rejected(), 1);
+}
+
+TEST_F(ClusterTest, PeerDenialCached)
+{
+    uint16_t state_id = 0;
+    receive(Cluster::m_entry, 801, 4825842, st_denied, 60);
+    EXPECT_TRUE(cached(801, 4825842, state_id));
+    EXPECT_EQ(state_id, st_denied);
+
+    receive(Cluster::m_entry, CACHE_ANY, 4825843, st_blocked, 60);
+    EXPECT_TRUE(cached(802, 4825843, state_id));
+    EXPECT_EQ(state_id, st_blocked);
+    EXPECT_EQ(cluster.rejected(), 0);
+}
+
+TEST_F(ClusterTest, PeerTtlClamped)
+{
+    uint16_t state_id;
+    receive(Cluster::m_entry, CACHE_ANY, 4825844, st_invalid, 65000);
+    EXPECT_TRUE(cached(801, 4825844, state_id));
+    hostAdvance((ttl_max + 1) * 1000000UL);
+    EXPECT_FALSE(cached(801, 4825844, state_id));
+}
+
+TEST_F(ClusterTest, WrongKeyRejected)
+{
+    uint16_t state_id;
+    receive(Cluster::m_entry, 801, 4825845, st_denied, 60, other_key);
+    EXPECT_FALSE(cached(801, 4825845, state_id));
+    EXPECT_EQ(cluster.rejected(), 1);
+}
+
+// own decisions go to group signed with key
+TEST_F(ClusterTest, ShareSigned)
+{
+    cluster.share(801, 4825846, st_denied, 60);
+
+    Cluster::Packet packet;
+    IPAddress to;
+    uint16_t to_port;
+    ASSERT_EQ(hostUdpSent((uint8_t*)&packet, sizeof(packet), &to, &to_port), (int)sizeof(packet));
+    EXPECT_EQ(to, group);
+    EXPECT_EQ(to_port, port);
+    EXPECT_EQ(packet.card_id, 4825846u);
+    EXPECT_TRUE(SipHash::verify(key, (const uint8_t*)&packet, offsetof(Cluster::Packet, mac), packet.mac));
+}
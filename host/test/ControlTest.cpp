@@ -0,0 +1,38 @@
+// gateway firmware with default flags: control frames of features switched off are dropped, not looked up
+
+#include <gtest/gtest.h>
+
+#include "GatewayHarness.h"
+
+#define ct_ack          115
+#define ct_heartbeat    116
+#define ct_status       117
+#define ct_door         120
+#define ct_last         127
+
+typedef GatewayHarness G;
+
+TEST(Control, NotLookedUp)
+{
+    G::start();
+    G::requests().clear();
+
+    const uint16_t states[] = { ct_ack, ct_heartbeat, ct_status, ct_door, ct_last };
+    for (uint16_t state_id : states)
+    {
+        EXPECT_TRUE(G::send(G::frame(801, 1000, state_id, 1)).empty()) << "state " << state_id;
+    }
+    EXPECT_TRUE(G::requests().empty());
+}
+
+TEST(Control, LookupStillLookedUp)
+{
+    G::start();
+    G::requests().clear();
+
+    std::vector<Message> answers = G::send(G::frame(801, 4825841));
+    ASSERT_EQ(answers.size(), 1u);
+    EXPECT_EQ(answers[0].card_id, 4825841u);
+    ASSERT_EQ(G::requests().size(), 1u);
+    EXPECT_FALSE(G::requests()[0].journal);
+}
@@ -0,0 +1,119 @@
+#ifndef GATEWAY_HARNESS_H
+#define GATEWAY_HARNESS_H
+
+// whole gateway firmware on simulated board: reader frames come from RS485 bus, lookups and journal reports go to
+// simulated http server, which answers with the state given by test
+
+#include <string>
+#include <vector>
+
+#include <Arduino.h>
+#include <Host.h>
+#include <Message.h>
+#include <SoftwareSerial.h>
+
+// firmware (main.cpp)
+void setup();
+void loop();
+extern SoftwareSerial rs485;
+
+struct GatewayHarness
+{
+    // request of gateway: lookup (status 0) or journal report
+    struct Request
+    {
+        bool            journal;
+        unsigned short  device_id;
+        unsigned long   card_id;
+        unsigned short  state_id;
+        unsigned short  other_id;
+    };
+
+    static std::vector<Request>& requests()
+    {
+        static std::vector<Request> requests;
+        return requests;
+    }
+
+    // state server gives to every card
+    static unsigned short& state()
+    {
+        static unsigned short state = 1;
+        return state;
+    }
+
+    static std::string server(const std::string& request)
+    {
+        Request r = {};
+        r.journal = request.find("/journal.php?") != std::string::npos;
+        const char* query = strstr(request.c_str(), "?id=");
+        if (query)
+        {
+            unsigned int device_id = 0, state_id = 0, other_id = 0;
+            sscanf(query, "?id=%lu&kod=%u&status=%u&other=%u", &r.card_id, &device_id, &state_id, &other_id);
+            r.device_id = device_id;
+            r.state_id = state_id;
+            r.other_id = other_id;
+        }
+        requests().push_back(r);
+
+        char response[160];
+        snprintf(response, sizeof(response), "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n\r\n"
+            "{\"id\":\"%lu\",\"kod\":\"%u\",\"status\":%u}", r.card_id, r.device_id, state());
+        return response;
+    }
+
+    // firmware starts once per test program (globals of main.cpp are not reset)
+    static void start()
+    {
+        static bool started = false;
+        if (started)
+            return;
+        started = true;
+        hostSerialOutput(nullptr);
+        hostHttpServer(server);
+        setup();
+        rs485.take();
+    }
+
+    // bus frame: header, size, message, xor checksum
+    static std::string frame(uint16_t device_id, uint32_t card_id, uint16_t state_id = 0, uint16_t other_id = 0)
+    {
+        Message message;
+        message.set(device_id, card_id, state_id, other_id);
+        const uint8_t* bytes = (const uint8_t*)&message;
+
+        std::string frame = { 0x06, (char)0x85, sizeof(Message) };
+        uint8_t checksum = sizeof(Message);
+        for (uint8_t i = 0; i < sizeof(Message); i++)
+        {
+            frame += (char)bytes[i];
+            checksum ^= bytes[i];
+        }
+        frame += (char)checksum;
+        return frame;
+    }
+
+    // reader sends frame, gateway runs for ms. returns frames gateway sent to bus meanwhile
+    static std::vector<Message> send(const std::string& frame, uint16_t ms = 100)
+    {
+        rs485.receive((const uint8_t*)frame.data(), frame.size());
+        for (uint16_t i = 0; i < ms; i++)
+        {
+            loop();
+            hostAdvance(1000);
+        }
+
+        std::string bus = rs485.take();
+        std::vector<Message> answers;
+        for (size_t i = 0; i + 4 + sizeof(Message) <= bus.size(); i += 4 + sizeof(Message))
+        {
+            Message message;
+            memcpy(&message, bus.data() + i + 3, sizeof(Message));
+            answers.push_back(message);
+        }
+        return answers;
+    }
+};
+
+#endif
@@ -0,0 +1,54 @@
+// gateway firmware with OPTIMISTIC: verification lookup after optimistic grant is about the swiped card
+
+#include <gtest/gtest.h>
+
+#include "GatewayHarness.h"
+
+#define st_allow        1
+#define st_denied       3
+#define jr_unconfirmed  90
+
+typedef GatewayHarness G;
+
+TEST(Optimistic, VerifiedCardIsSwipedCard)
+{
+    G::start();
+    G::requests().clear();
+
+    // server allows card: the next swipe is granted before lookup
+    std::vector<Message> first = G::send(G::frame(801, 4825841));
+    ASSERT_EQ(first.size(), 1u);
+    EXPECT_EQ(first[0].state_id, st_allow);
+    ASSERT_EQ(G::requests().size(), 1u);
+
+    std::vector<Message> second = G::send(G::frame(801, 4825841));
+    ASSERT_EQ(second.size(), 1u);
+    EXPECT_EQ(second[0].card_id, 4825841u);
+    EXPECT_EQ(second[0].state_id, st_allow);
+
+    ASSERT_EQ(G::requests().size(), 2u);
+    EXPECT_FALSE(G::requests()[1].journal);
+    EXPECT_EQ(G::requests()[1].device_id, 801);
+    EXPECT_EQ(G::requests()[1].card_id, 4825841u);
+}
+
+// server denies granted card: alert goes to journal endpoint, not to lookup
+TEST(Optimistic, UnconfirmedGrantJournaled)
+{
+    G::start();
+    G::send(G::frame(802, 4825842));
+    G::requests().clear();
+
+    G::state() = st_denied;
+    std::vector<Message> answers = G::send(G::frame(802, 4825842), 1000);
+    G::state() = st_allow;
+    ASSERT_EQ(answers.size(), 1u);
+    EXPECT_EQ(answers[0].state_id, st_allow);
+
+    ASSERT_EQ(G::requests().size(), 2u);
+    EXPECT_FALSE(G::requests()[0].journal);
+    EXPECT_TRUE(G::requests()[1].journal);
+    EXPECT_EQ(G::requests()[1].card_id, 4825842u);
+    EXPECT_EQ(G::requests()[1].state_id, jr_unconfirmed);
+    EXPECT_EQ(G::requests()[1].other_id, st_denied);
+}
@@ -0,0 +1,131 @@
+// replay of bus traces by TraceStream: frames cut by record boundaries reach Channel the same as from contiguous line
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include <Arduino.h>
+#include <Host.h>
+#include <Channel.h>
+#include <Message.h>
+#include <TraceStream.h>
+
+namespace
+{
+
+// bus frame: header, size, message, xor checksum
+std::vector<uint8_t> frame(uint16_t device_id, uint32_t card_id)
+{
+    Message message;
+    message.set(device_id, card_id, 1, 0);
+    const uint8_t* bytes = (const uint8_t*)&message;
+
+    std::vector<uint8_t> frame = { 0x06, 0x85, sizeof(Message) };
+    uint8_t checksum = sizeof(Message);
+    for (uint8_t i = 0; i < sizeof(Message); i++)
+    {
+        frame.push_back(bytes[i]);
+        checksum ^= bytes[i];
+    }
+    frame.push_back(checksum);
+    return frame;
+}
+
+// '~r' records of given lengths (the last one takes the rest)
+std::string records(const std::vector<uint8_t>& bytes, const std::vector<size_t>& lengths)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    std::string trace;
+    size_t position = 0;
+    for (size_t i = 0; position < bytes.size(); i++)
+    {
+        size_t length = i < lengths.size() ? lengths[i] : bytes.size() - position;
+        length = std::min(length, bytes.size() - position);
+        trace += "~r5:";
+        for (size_t b = position; b < position + length; b++)
+        {
+            trace += hex[bytes[b] >> 4];
+            trace += hex[bytes[b] & 0x0F];
+        }
+        trace += '\n';
+        position += length;
+    }
+    return trace;
+}
+
+// card ids of frames Channel receives while trace is replayed (with time passing as in loop of firmware)
+std::vector<uint32_t> replay(const std::string& trace)
+{
+    hostSerialOutput(nullptr);
+    while (hostSerialPending() > 0)
+        Serial.read();
+    hostSerialInput(trace.data(), trace.size());
+
+    TraceStream stream;
+    Channel<Message> channel;
+    channel.begin(&stream);
+    stream.replay(&Serial, &Serial);
+
+    std::vector<uint32_t> cards;
+    for (uint32_t i = 0; i < 20000; i++)
+    {
+        const Message* received = channel.receive();
+        if (received)
+            cards.push_back(received->card_id);
+        hostAdvance(100);
+    }
+    return cards;
+}
+
+std::vector<uint8_t> frames(uint8_t count)
+{
+    std::vector<uint8_t> bytes;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        std::vector<uint8_t> f = frame(803 + i % 2, 4825841 + i);
+        bytes.insert(bytes.end(), f.begin(), f.end());
+    }
+    return bytes;
+}
+
+std::vector<uint32_t> cards(uint8_t count)
+{
+    std::vector<uint32_t> cards;
+    for (uint8_t i = 0; i < count; i++)
+        cards.push_back(4825841 + i);
+    return cards;
+}
+
+}
+
+// record ends with the first header byte of the next frame
+TEST(TraceStream, HeaderByteAtRecordEnd)
+{
+    EXPECT_EQ(replay(records(frames(2), { 15 })), cards(2));
+}
+
+// record ends with two header bytes
+TEST(TraceStream, TwoHeaderBytesAtRecordEnd)
+{
+    EXPECT_EQ(replay(records(frames(2), { 16 })), cards(2));
+}
+
+// records are cut at TRACE_BURST bytes, frames are 14 bytes: every boundary falls on another place of frame
+TEST(TraceStream, RecordsOfBurstLength)
+{
+    EXPECT_EQ(replay(records(frames(8), std::vector<size_t>(8, TRACE_BURST))), cards(8));
+}
+
+// the last 1-2 bytes of trace are the end of frame (not a header waiting for the next record)
+TEST(TraceStream, FrameTailEndsTrace)
+{
+    EXPECT_EQ(replay(records(frames(5), { 16, 16, 16, 16 })), cards(5));
+    EXPECT_EQ(replay(records(frames(2), { 13, 14 })), cards(2));
+}
+
+// every record length from 1 to TRACE_BURST
+TEST(TraceStream, AnyRecordLength)
+{
+    for (size_t length = 1; length <= TRACE_BURST; length++)
+        EXPECT_EQ(replay(records(frames(4), std::vector<size_t>(64, length))), cards(4)) << "record length " << length;
+}
@@ -0,0 +1,102 @@
+// udp lookups: replies are taken only from server, for device and card of request
+
+#include <gtest/gtest.h>
+
+#include <Arduino.h>
+#include <Host.h>
+#include <UdpLink.h>
+
+namespace
+{
+
+#define server_port     8585
+#define local_port      8586
+
+const IPAddress server(10, 0, 0, 1);
+const IPAddress stranger(10, 0, 0, 66);
+
+class UdpLinkTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(link.begin("10.0.0.1", server_port, local_port));
+        while (sent(request))
+            ;
+    }
+
+    // the oldest request of link
+    bool sent(UdpLink::Datagram& datagram)
+    {
+        return hostUdpSent((uint8_t*)&datagram, sizeof(datagram)) == (int)sizeof(datagram);
+    }
+
+    void reply(const IPAddress& from, uint16_t from_port, uint16_t request_id, unsigned short device_id, unsigned long card_id)
+    {
+        UdpLink::Datagram datagram = request;
+        datagram.request_id = request_id;
+        datagram.device_id = device_id;
+        datagram.card_id = card_id;
+        datagram.state_id = 1;
+        hostUdpInput(local_port, from, from_port, (const uint8_t*)&datagram, sizeof(datagram));
+    }
+
+    UdpLink             link;
+    UdpLink::Datagram   request;
+    UdpLink::Result     result;
+};
+
+}
+
+TEST_F(UdpLinkTest, ReplyOfServer)
+{
+    ASSERT_TRUE(link.request(801, 4825841));
+    ASSERT_TRUE(sent(request));
+
+    reply(server, server_port, request.request_id, 801, 4825841);
+    ASSERT_TRUE(link.update(result));
+    EXPECT_FALSE(result.timeout);
+    EXPECT_EQ(result.device_id, 801);
+    EXPECT_EQ(result.card_id, 4825841u);
+    EXPECT_EQ(result.state_id, 1);
+}
+
+// datagram with right id from other host or port is not a reply
+TEST_F(UdpLinkTest, ForeignSourceDropped)
+{
+    ASSERT_TRUE(link.request(801, 4825842));
+    ASSERT_TRUE(sent(request));
+
+    reply(stranger, server_port, request.request_id, 801, 4825842);
+    reply(server, server_port + 1, request.request_id, 801, 4825842);
+    EXPECT_FALSE(link.update(result));
+    EXPECT_EQ(link.pending(), 1);
+}
+
+// reply can not move decision to other device or card
+TEST_F(UdpLinkTest, ResultIsOfRequest)
+{
+    ASSERT_TRUE(link.request(801, 4825843));
+    ASSERT_TRUE(sent(request));
+
+    reply(server, server_port, request.request_id, 802, 4825843);
+    ASSERT_TRUE(link.update(result));
+    EXPECT_EQ(result.device_id, 801);
+    EXPECT_EQ(result.card_id, 4825843u);
+
+    ASSERT_TRUE(link.request(801, 4825844));
+    ASSERT_TRUE(sent(request));
+    reply(server, server_port, request.request_id, 801, 4825899);
+    EXPECT_FALSE(link.update(result));
+}
+
+TEST_F(UdpLinkTest, RequestIdsNotSequential)
+{
+    UdpLink::Datagram first;
+    ASSERT_TRUE(link.request(801, 4825845));
+    ASSERT_TRUE(sent(first));
+    ASSERT_TRUE(link.request(801, 4825846));
+    ASSERT_TRUE(sent(request));
+    EXPECT_NE(request.request_id, first.request_id);
+    EXPECT_NE(request.request_id, (uint16_t)(first.request_id + 1));
+}
@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+# Builds card index image for Arduino Uno (CARD_INDEX) from server card export.
+#
+#   card_index.py <export> --version <n> --bin <image.bin>          image for external SPI flash slot (A or B)
+#   card_index.py <export> --version <n> --header <CardIndexData.h>  image in PROGMEM (compiled into firmware)
+#
+# Export is text or csv: first number of every line is card id (lines without number are skipped).
+# Write new version to the slot which is not used now (e.g. with flashrom or any SPI programmer), gateway takes
+# the valid image with the greatest version on start, so half-written image is never used.
+#
+# Image (little-endian): header, fence (first card of every block), blocks of sorted card ids (last one padded with 0xFFFFFFFF)
+# Block size is chosen so that block and piece of fence between 32 RAM samples are not longer than 40 cards, lookup is
+# two reads then (up to 51200 cards).
+#   magic u32 'CIDX', version u32, count u32, blocks u16, block cards u8, reserved u8, crc32 u32 (of fence and blocks)
+
+import argparse
+import re
+import struct
+import sys
+import zlib
+
+MAGIC = 0x58444943
+BLOCK_CARDS = 16                                # the least block (64 bytes)
+TOP = 32                                        # CARD_INDEX_TOP
+READ = 40                                       # CARD_INDEX_READ
+HEADER = struct.Struct("<LLLHBBL")
+
+
+def load(path):
+    cards = set()
+    number = re.compile(r"\d+")
+    with open(path) as f:
+        for line in f:
+            match = number.search(line)
+            if match:
+                card = int(match.group())
+                if 0 < card < 0xFFFFFFFF:
+                    cards.add(card)
+    return sorted(cards)
+
+
+def block_size(count):
+    # the least block with piece of fence (blocks / TOP) not longer than READ
+    for block_cards in range(BLOCK_CARDS, READ + 1):
+        blocks = max(1, (count + block_cards - 1) // block_cards)
+        if (blocks + TOP - 1) // TOP <= block_cards:
+            return block_cards, blocks
+    sys.exit(f"{count} cards do not fit into index (at most {TOP * READ * READ})")
+
+
+def build(cards, version):
+    block_cards, blocks = block_size(len(cards))
+    padded = cards + [0xFFFFFFFF] * (blocks * block_cards - len(cards))
+    fence = [padded[i * block_cards] for i in range(blocks)]
+    body = struct.pack(f"<{blocks}L", *fence) + struct.pack(f"<{len(padded)}L", *padded)
+    header = HEADER.pack(MAGIC, version, len(cards), blocks, block_cards, 0, zlib.crc32(body))
+    return header + body, block_cards, blocks
+
+
+def header_file(image, version, count):
+    lines = [
+        "// generated by tools/card_index.py, do not edit",
+        f"// version {version}, {count} cards",
+        "#ifndef CARD_INDEX_DATA_H",
+        "#define CARD_INDEX_DATA_H",
+        "",
+        "#include <Arduino.h>",
+        "",
+        "const uint8_t card_index_image[] PROGMEM = {",
+    ]
+    for i in range(0, len(image), 16):
+        lines.append("    " + ", ".join(f"0x{b:02X}" for b in image[i:i + 16]) + ",")
+    lines += ["};", "", "#endif", ""]
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="card index image builder")
+    parser.add_argument("export", help="card export of server")
+    parser.add_argument("--version", type=int, required=True, help="image version (greater - newer)")
+    parser.add_argument("--bin", help="output image for SPI flash")
+    parser.add_argument("--header", help="output C header with PROGMEM image")
+    args = parser.parse_args()
+
+    if not args.bin and not args.header:
+        parser.error("--bin or --header is required")
+
+    cards = load(args.export)
+    image, block_cards, blocks = build(cards, args.version)
+    if args.bin:
+        with open(args.bin, "wb") as f:
+            f.write(image)
+    if args.header:
+        with open(args.header, "w") as f:
+            f.write(header_file(image, args.version, len(cards)))
+    print(f"{len(cards)} cards, {blocks} blocks of {block_cards}, {len(image)} bytes", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,193 @@
+#!/usr/bin/env python3
+# Gateway cluster peer on Linux: speaks the same multicast messages as gateways built with CLUSTER.
+#
+#   cluster_peer.py listen                  print messages of the group
+#   cluster_peer.py invalidate <card>       tell gateways to forget decisions about card (e.g. after card change in database)
+#   cluster_peer.py simulate [options]      act as gateway with simulated readers and backend
+#
+# Several 'simulate' processes on one host form a cluster: each swipes random cards on its own devices, answers from cache
+# (filled by itself and by peers) and asks simulated backend on miss. Backend load and hit rate are printed at the end,
+# so adding processes shows how the cluster shares the load.
+#   for i in 1 2 3; do tools/cluster_peer.py simulate --device $((i * 10)) & done; wait
+#
+# Messages are signed with key of site (CLUSTER_SITE_KEY of gateways): --key or CLUSTER_KEY environment variable,
+# 32 hex digits. There is no default key.
+
+import argparse
+import os
+import random
+import socket
+import struct
+import time
+
+from priority_command import siphash
+
+GROUP = "239.1.85.85"
+PORT = 8586
+MAGIC = 0x43
+PACKET = struct.Struct("<BBHHLH")               # magic, type, ttl, device id, card id, state id
+TAG = struct.Struct("<Q")                       # siphash-2-4 of packet
+
+M_HELLO, M_ENTRY, M_INVALIDATE, M_PRESENCE = 1, 2, 3, 4
+ST_ALLOW, ST_DENIED, ST_INVALID, ST_BLOCKED = 1, 3, 4, 5
+CACHE_ANY = 0
+TTL_CARD, TTL_DENIED = 300, 60
+ACCEPTED = (ST_DENIED, ST_INVALID, ST_BLOCKED)  # decisions taken from peers (cl_accepted)
+
+
+def open_socket():
+    s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM, socket.IPPROTO_UDP)
+    s.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    if hasattr(socket, "SO_REUSEPORT"):
+        s.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEPORT, 1)
+    s.bind(("", PORT))
+    s.setsockopt(socket.IPPROTO_IP, socket.IP_ADD_MEMBERSHIP,
+                 socket.inet_aton(GROUP) + socket.inet_aton("0.0.0.0"))
+    s.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_LOOP, 1)
+    return s
+
+
+key = None                                      # shared key of site
+
+
+def send(s, kind, device=0, card=0, state=0, ttl=0):
+    packet = PACKET.pack(MAGIC, kind, ttl, device, card, state)
+    s.sendto(packet + TAG.pack(siphash(key, packet)), (GROUP, PORT))
+
+
+def receive(s):
+    data, sender = s.recvfrom(64)
+    if len(data) != PACKET.size + TAG.size or data[0] != MAGIC:
+        return None, sender
+    packet = data[:PACKET.size]
+    if TAG.unpack_from(data, PACKET.size)[0] != siphash(key, packet):
+        return None, sender
+    return PACKET.unpack(packet), sender
+
+
+def listen(s):
+    names = {M_HELLO: "hello", M_ENTRY: "entry", M_INVALIDATE: "invalidate", M_PRESENCE: "presence"}
+    while True:
+        packet, sender = receive(s)
+        if packet:
+            _, kind, ttl, device, card, state = packet
+            print(f"{sender[0]}:{sender[1]}\t{names.get(kind, kind)}\tdevice={device}\tcard={card}\tstate={state}\tttl={ttl}")
+
+
+class Gateway:
+    """the same caching rules as rememberDecision() of firmware"""
+
+    def __init__(self, s, devices, cards, seed):
+        self.s = s
+        self.devices = devices
+        self.cards = cards
+        self.cache = {}                         # (device, card) -> (state, expires)
+        self.random = random.Random(seed)
+        self.lookups = self.hits = self.swipes = 0
+        self.s.setblocking(False)
+
+    def backend(self, device, card):
+        # deterministic database: every 7th card unknown, every 11th blocked, every 5th denied on odd devices
+        self.lookups += 1
+        if card % 7 == 0:
+            return ST_INVALID
+        if card % 11 == 0:
+            return ST_BLOCKED
+        if card % 5 == 0 and device % 2:
+            return ST_DENIED
+        return ST_ALLOW
+
+    def get(self, device, card):
+        now = time.monotonic()
+        for key in ((device, card), (CACHE_ANY, card)):
+            entry = self.cache.get(key)
+            if entry and entry[1] > now:
+                return entry[0]
+        return None
+
+    def invalidate(self, card):
+        for key in [k for k in self.cache if k[1] == card]:
+            del self.cache[key]
+
+    def remember(self, device, card, state):
+        now = time.monotonic()
+        if state in (ST_INVALID, ST_BLOCKED):
+            self.cache[(CACHE_ANY, card)] = (state, now + TTL_CARD)
+            send(self.s, M_ENTRY, CACHE_ANY, card, state, TTL_CARD)
+        elif state == ST_DENIED:
+            self.cache[(device, card)] = (state, now + TTL_DENIED)
+            send(self.s, M_ENTRY, device, card, state, TTL_DENIED)
+        elif state == ST_ALLOW:
+            self.invalidate(card)
+            send(self.s, M_PRESENCE, device, card, state)
+
+    def drain(self):
+        while True:
+            try:
+                packet, _ = receive(self.s)
+            except BlockingIOError:
+                return
+            if not packet:
+                continue
+            _, kind, ttl, device, card, state = packet
+            if kind == M_ENTRY and state in ACCEPTED:
+                self.cache[(device, card)] = (state, time.monotonic() + min(ttl, TTL_CARD))
+            elif kind in (M_INVALIDATE, M_PRESENCE):
+                self.invalidate(card)
+
+    def swipe(self):
+        self.drain()
+        device = self.random.choice(self.devices)
+        card = self.random.randint(1, self.cards)
+        self.swipes += 1
+        if self.get(device, card) is not None:
+            self.hits += 1
+            return
+        self.remember(device, card, self.backend(device, card))
+
+
+def simulate(s, args):
+    devices = list(range(args.device, args.device + args.readers))
+    gateway = Gateway(s, devices, args.cards, args.seed or args.device)
+    send(s, M_HELLO)
+    for _ in range(args.swipes):
+        gateway.swipe()
+        time.sleep(args.interval)
+    gateway.drain()
+    print(f"gateway {args.device}: swipes={gateway.swipes} hits={gateway.hits} "
+          f"backend={gateway.lookups} hit rate={gateway.hits * 100 // max(gateway.swipes, 1)}%")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="gateway cluster peer")
+    parser.add_argument("--key", default=os.environ.get("CLUSTER_KEY"), help="shared key of site, 32 hex digits")
+    commands = parser.add_subparsers(dest="command", required=True)
+    commands.add_parser("listen")
+    invalidate = commands.add_parser("invalidate")
+    invalidate.add_argument("card", type=int)
+    sim = commands.add_parser("simulate")
+    sim.add_argument("--device", type=int, default=10, help="id of first reader of gateway")
+    sim.add_argument("--readers", type=int, default=4, help="readers of gateway")
+    sim.add_argument("--cards", type=int, default=200, help="cards in database")
+    sim.add_argument("--swipes", type=int, default=2000)
+    sim.add_argument("--interval", type=float, default=0.005, help="seconds between swipes")
+    sim.add_argument("--seed", type=int, default=0)
+    args = parser.parse_args()
+    if not args.key:
+        parser.error("key of site is required: --key or CLUSTER_KEY")
+    global key
+    key = bytes.fromhex(args.key)
+    if len(key) != 16:
+        parser.error("key is 16 bytes (32 hex digits)")
+
+    s = open_socket()
+    if args.command == "listen":
+        listen(s)
+    elif args.command == "invalidate":
+        send(s, M_INVALIDATE, card=args.card)
+    else:
+        simulate(s, args)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,185 @@
+#!/usr/bin/env python3
+# Mock of lookup server (GET /skd.mk/baseadd2.php?id=&kod=) for testing gateway with BACKENDS, and of UDP lookup
+# (UDP_TRANSPORT, 14 bytes datagrams of UdpLink, see README).
+#
+#   mock_server.py --port 8080 [--port 8081 ...] [--udp 8585 ...] [--delay ms] [--jitter ms] [--fail rate] [--stall rate]
+#
+# Every port is a separate server with its own behaviour changeable at runtime from stdin:
+#   <port> delay <ms>       answer latency
+#   <port> fail <rate>      part of requests closed without answer (0..1), udp: request dropped
+#   <port> stall <rate>     part of requests never answered (gateway hedges or times out), udp: request dropped
+#   <port> down / up        stop / start listening (health checks fail / pass)
+# Status of card is taken from its id (id % 6: 1 allow, 3 denied, 4 invalid, 5 blocked, other allow).
+# Every request is printed with port and latency, '&hedge=1' marks the second request of hedged lookup.
+# Journal reports of gateway (GET /skd.mk/journal.php?id=&kod=&status=[&other=]) are printed as 'journal', answer is the card status.
+# Requests with '&trace=' (TRACE_IDS) also print '$srv_rx' / '$srv_tx' lines for tools/trace_join.py.
+
+import argparse
+import random
+import socket
+import struct
+import sys
+import threading
+import time
+from urllib.parse import parse_qs, urlparse
+
+STATES = {1: 1, 3: 3, 4: 4, 5: 5}
+DATAGRAM = struct.Struct("<BBHHLHH")            # magic, type, request id, device id, card id, state id, other id
+UDP_MAGIC = 0x53
+UDP_LOOKUP = 1
+
+
+class Backend:
+    def __init__(self, port, delay, jitter, fail, stall, udp=False):
+        self.port = port
+        self.udp = udp
+        self.delay = delay
+        self.jitter = jitter
+        self.fail = fail
+        self.stall = stall
+        self.listening = False
+        self.sock = None
+
+    def start(self):
+        if self.listening:
+            return
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM if self.udp else socket.SOCK_STREAM)
+        self.sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        self.sock.bind(("", self.port))
+        self.listening = True
+        if self.udp:
+            threading.Thread(target=self.receive, daemon=True).start()
+        else:
+            self.sock.listen(8)
+            threading.Thread(target=self.accept, daemon=True).start()
+
+    def stop(self):
+        self.listening = False
+        if self.sock:
+            self.sock.close()
+
+    def accept(self):
+        sock = self.sock
+        while self.listening:
+            try:
+                connection, _ = sock.accept()
+            except OSError:
+                return
+            threading.Thread(target=self.serve, args=(connection,), daemon=True).start()
+
+    def receive(self):
+        sock = self.sock
+        while self.listening:
+            try:
+                data, address = sock.recvfrom(64)
+            except OSError:
+                return
+            if len(data) != DATAGRAM.size:
+                print(f"{self.port}: {len(data)} bytes datagram skipped", flush=True)
+                continue
+            magic, kind, request_id, device, card, _, _ = DATAGRAM.unpack(data)
+            if magic != UDP_MAGIC or kind != UDP_LOOKUP:
+                print(f"{self.port}: datagram magic={magic:#x} type={kind} skipped", flush=True)
+                continue
+            threading.Thread(target=self.reply, args=(sock, address, request_id, device, card), daemon=True).start()
+
+    def reply(self, sock, address, request_id, device, card):
+        started = time.time()
+        if random.random() < self.stall + self.fail:
+            print(f"{self.port}: id={card} kod={device} request={request_id} dropped", flush=True)
+            return
+
+        time.sleep(max(0, self.delay + random.uniform(-self.jitter, self.jitter)) / 1000)
+        state = STATES.get(card % 6, 1)
+        try:
+            sock.sendto(DATAGRAM.pack(UDP_MAGIC, UDP_LOOKUP, request_id, device, card, state, 0), address)
+        except OSError:
+            return
+        print(f"{self.port}: id={card} kod={device} request={request_id} status={state} "
+              f"{(time.time() - started) * 1000:.0f} ms udp", flush=True)
+
+    def serve(self, connection):
+        started = time.time()
+        with connection:
+            request = b""
+            while b"\r\n\r\n" not in request:
+                chunk = connection.recv(512)
+                if not chunk:
+                    return
+                request += chunk
+
+            line = request.split(b"\r\n", 1)[0].decode(errors="replace")
+            url = urlparse(line.split(" ")[1])
+            query = parse_qs(url.query)
+            journal = url.path.endswith("/journal.php")
+            card = int(query.get("id", ["0"])[0])
+            device = int(query.get("kod", ["0"])[0])
+            hedge = "hedge" in query
+            trace = query.get("trace", [None])[0]
+            if trace is not None:
+                print(f"$srv_rx:{device}:{trace}:{time.monotonic_ns() // 1000}", flush=True)
+
+            roll = random.random()
+            if roll < self.stall:
+                time.sleep(30)
+                return
+            if roll < self.stall + self.fail:
+                print(f"{self.port}: id={card} kod={device} closed", flush=True)
+                return
+
+            time.sleep(max(0, self.delay + random.uniform(-self.jitter, self.jitter)) / 1000)
+            state = STATES.get(card % 6, 1)
+            body = f'{{"id":"{card}","kod":"{device}","status":{state}}}'
+            connection.sendall(
+                f"HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: {len(body)}\r\n"
+                f"Connection: close\r\n\r\n{body}".encode())
+            if trace is not None:
+                print(f"$srv_tx:{device}:{trace}:{time.monotonic_ns() // 1000}:{state}", flush=True)
+            if journal:
+                print(f"{self.port}: journal id={card} kod={device} status={query.get('status', ['?'])[0]} "
+                      f"other={query.get('other', ['0'])[0]}", flush=True)
+                return
+            print(f"{self.port}: id={card} kod={device} status={state} {(time.time() - started) * 1000:.0f} ms"
+                  f"{' hedge' if hedge else ''}", flush=True)
+
+
+def control(backends):
+    for line in sys.stdin:
+        words = line.split()
+        if len(words) < 2 or int(words[0]) not in backends:
+            print("<port> delay|fail|stall <value> | <port> down|up", flush=True)
+            continue
+        backend = backends[int(words[0])]
+        command = words[1]
+        if command == "down":
+            backend.stop()
+        elif command == "up":
+            backend.start()
+        elif command in ("delay", "fail", "stall") and len(words) == 3:
+            setattr(backend, command, float(words[2]))
+        print(f"{backend.port}: delay={backend.delay} fail={backend.fail} stall={backend.stall} "
+              f"{'up' if backend.listening else 'down'}", flush=True)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="lookup server mock")
+    parser.add_argument("--port", type=int, action="append", default=[], help="http port (repeat for more servers)")
+    parser.add_argument("--udp", type=int, action="append", default=[], help="udp lookup port, e.g. 8585 (srvr_udp_port)")
+    parser.add_argument("--delay", type=float, default=50, help="answer latency, ms")
+    parser.add_argument("--jitter", type=float, default=20, help="latency jitter, ms")
+    parser.add_argument("--fail", type=float, default=0, help="part of requests closed without answer")
+    parser.add_argument("--stall", type=float, default=0, help="part of requests never answered")
+    args = parser.parse_args()
+    if not args.port and not args.udp:
+        parser.error("--port or --udp is required")
+
+    backends = {port: Backend(port, args.delay, args.jitter, args.fail, args.stall) for port in args.port}
+    backends.update({port: Backend(port, args.delay, args.jitter, args.fail, args.stall, True) for port in args.udp})
+    for backend in backends.values():
+        backend.start()
+    print(f"listening on {', '.join(map(str, backends))}", flush=True)
+    control(backends)
+
+
+if __name__ == "__main__":
+    main()
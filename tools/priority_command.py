@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+# Sends site-wide priority command to gateway built with PRIORITY and prints its fan-out result.
+#
+#   priority_command.py <gateway ip> unlock|lockdown|normal|flush [--port 8588] [--timeout 3] --key <32 hex digits>
+#
+# Gateway repeats the command on its buses until every registered reader acknowledged it (or tries are over) and answers
+# with the time from the first frame to the last acknowledgement, or with registry positions of readers which were silent.
+# Command is signed with key of site (PRIORITY_SITE_KEY of gateway; --key or PRIORITY_KEY environment variable, no default) and carries
+# nonce greater than every nonce sent before (unix time, at least last one + 1, kept in --nonce-file): gateway drops
+# datagrams with wrong tag or old nonce without answer.
+
+import argparse
+import os
+import socket
+import struct
+import sys
+import time
+
+MAGIC = 0x50
+COMMAND = struct.Struct("<BBI")                 # magic, command, nonce (followed by 8 bytes of siphash-2-4 tag)
+PACKET = struct.Struct("<BBHHH")                # magic, command, sequence, fanout ms, missing positions
+COMMANDS = {"normal": 0, "unlock": 1, "lockdown": 2, "flush": 3}
+INCOMPLETE = 0xFFFF
+MASK = (1 << 64) - 1
+
+
+def rotl(x, b):
+    return ((x << b) | (x >> (64 - b))) & MASK
+
+
+def siphash(key, data):
+    # siphash-2-4, 64-bit tag
+    k0, k1 = struct.unpack("<QQ", key)
+    v = [k0 ^ 0x736f6d6570736575, k1 ^ 0x646f72616e646f6d, k0 ^ 0x6c7967656e657261, k1 ^ 0x7465646279746573]
+
+    def rounds(n):
+        for _ in range(n):
+            v[0] = (v[0] + v[1]) & MASK; v[1] = rotl(v[1], 13) ^ v[0]; v[0] = rotl(v[0], 32)
+            v[2] = (v[2] + v[3]) & MASK; v[3] = rotl(v[3], 16) ^ v[2]
+            v[0] = (v[0] + v[3]) & MASK; v[3] = rotl(v[3], 21) ^ v[0]
+            v[2] = (v[2] + v[1]) & MASK; v[1] = rotl(v[1], 17) ^ v[2]; v[2] = rotl(v[2], 32)
+
+    tail = len(data) // 8 * 8
+    words = [struct.unpack_from("<Q", data, i)[0] for i in range(0, tail, 8)]
+    words.append(int.from_bytes(data[tail:], "little") | (len(data) & 0xFF) << 56)
+    for m in words:
+        v[3] ^= m
+        rounds(2)
+        v[0] ^= m
+    v[2] ^= 0xFF
+    rounds(4)
+    return v[0] ^ v[1] ^ v[2] ^ v[3]
+
+
+def next_nonce(path):
+    last = 0
+    try:
+        with open(path) as f:
+            last = int(f.read().strip() or 0)
+    except (OSError, ValueError):
+        pass
+    nonce = max(int(time.time()), last + 1) & 0xFFFFFFFF
+    with open(path, "w") as f:
+        f.write(str(nonce))
+    return nonce
+
+
+def main():
+    parser = argparse.ArgumentParser(description="priority command of gateway")
+    parser.add_argument("gateway", help="ip address of gateway")
+    parser.add_argument("command", choices=COMMANDS)
+    parser.add_argument("--port", type=int, default=8588)
+    parser.add_argument("--timeout", type=float, default=3.0, help="seconds to wait for result")
+    parser.add_argument("--key", default=os.environ.get("PRIORITY_KEY"), help="shared key of site, 32 hex digits")
+    parser.add_argument("--nonce-file", default=os.path.expanduser("~/.priority_nonce"), help="last sent nonce")
+    args = parser.parse_args()
+
+    if not args.key:
+        parser.error("key of site is required: --key or PRIORITY_KEY")
+    key = bytes.fromhex(args.key)
+    if len(key) != 16:
+        parser.error("key is 16 bytes (32 hex digits)")
+
+    command = COMMANDS[args.command]
+    signed = COMMAND.pack(MAGIC, command, next_nonce(args.nonce_file))
+    datagram = signed + struct.pack("<Q", siphash(key, signed))
+    with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as sock:
+        sock.settimeout(args.timeout)
+        sock.sendto(datagram, (args.gateway, args.port))
+        while True:
+            try:
+                data, _ = sock.recvfrom(64)
+            except socket.timeout:
+                print("no result from gateway (wrong key or source address?)", file=sys.stderr)
+                sys.exit(2)
+            if len(data) != PACKET.size:
+                continue
+            magic, answered, sequence, fanout, missing = PACKET.unpack(data)
+            if magic == MAGIC and answered == command:
+                break
+
+    if fanout != INCOMPLETE:
+        print(f"{args.command}: sequence {sequence}, fan-out {fanout} ms")
+        return
+    positions = [str(i) for i in range(16) if missing & (1 << i)]
+    print(f"{args.command}: sequence {sequence}, not acknowledged by readers at positions {', '.join(positions)}")
+    sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,195 @@
+#!/usr/bin/env python3
+# Joins stage lines of card transactions (TRACE_IDS) from reader, gateway and server logs into latency breakdowns.
+#
+#   trace_join.py --reader nano1.log [--reader nano2.log ...] --gateway uno.log [--server mock.log] [--top 10]
+#
+# Logs are serial captures of firmwares built with TRACE_IDS (debug output between lines is skipped) and output of
+# tools/mock_server.py. Line: $<stage>:<device id>:<trace id>:<micros>[:<state>]
+#   reader:  tx, retry, busy, rx:<state>
+#   gateway: rx, srv>, srv<, tx:<state>
+#   server:  srv_rx, srv_tx:<state>
+# Clocks of devices are not synchronized, so only differences inside one log are used:
+#   reader      - swipe sent .. answer handled (whole transaction seen by reader)
+#   gateway     - frame received .. answer sent (busy answers and retries of lookup are summed)
+#   bus         - reader - gateway (RS485 frames, polling and queueing on both sides)
+#   upstream    - request sent .. answer parsed on gateway
+#   server      - request received .. answer sent on server (first answered of hedged requests)
+#   network     - upstream - server (ethernet, TCP, DNS)
+#   local       - gateway - upstream (coalescing, cache, filters, admission)
+# Transactions are joined by device id and trace id, repeated ids (wrap, restart) are joined in order.
+
+import argparse
+import math
+import re
+import sys
+from collections import defaultdict
+
+LINE = re.compile(r"\$([a-z_<>]+):(\d+):(\d+):(\d+)(?::(\d+))?")
+ST_BUSY = 6
+HEDGE_WINDOW = 5000000                          # us, requests of one trace closer than this are one lookup (hedge)
+
+
+def elapsed(start, end):
+    # micros() of AVR wraps at 2^32
+    return (end - start) % (1 << 32)
+
+
+def stages(path):
+    with open(path, errors="replace") as f:
+        for line in f:
+            match = LINE.search(line)
+            if match:
+                name, device, trace, micros, state = match.groups()
+                yield name, (int(device), int(trace)), int(micros), None if state is None else int(state)
+
+
+def reader_log(path):
+    # key -> [{"total": us, "state": n, "retries": n}]
+    done = defaultdict(list)
+    open_ = {}
+    for name, key, micros, state in stages(path):
+        if name == "tx":
+            open_[key] = {"start": micros, "retries": 0}
+        elif key not in open_:
+            continue
+        elif name == "retry":
+            open_[key]["retries"] += 1
+        elif name == "rx":
+            item = open_.pop(key)
+            done[key].append({"total": elapsed(item["start"], micros), "state": state, "retries": item["retries"]})
+    return done
+
+
+def gateway_log(path):
+    # key -> [{"total": us, "upstream": us or None, "state": n}], busy answer and its retry are one transaction
+    done = defaultdict(list)
+    open_ = {}
+    for name, key, micros, state in stages(path):
+        if name == "rx":
+            open_[key] = {"start": micros, "sent": None, "upstream": None}
+        elif key not in open_:
+            continue
+        elif name == "srv>":
+            open_[key]["sent"] = micros
+        elif name == "srv<" and open_[key]["sent"] is not None:
+            open_[key]["upstream"] = elapsed(open_[key]["sent"], micros)
+        elif name == "tx":
+            item = open_.pop(key)
+            total = elapsed(item["start"], micros)
+            previous = done[key][-1] if done[key] else None
+            if previous and previous["state"] == ST_BUSY:
+                previous["total"] += total
+                if item["upstream"] is not None:
+                    previous["upstream"] = (previous["upstream"] or 0) + item["upstream"]
+                previous["state"] = state
+            else:
+                done[key].append({"total": total, "upstream": item["upstream"], "state": state})
+    return done
+
+
+def server_log(path):
+    # key -> [{"server": us}], hedged requests of one lookup are one item (first answer wins)
+    requests = defaultdict(list)
+    for name, key, micros, state in stages(path):
+        if name == "srv_rx":
+            requests[key].append({"start": micros, "end": None})
+        elif name == "srv_tx":
+            for request in requests[key]:
+                if request["end"] is None:
+                    request["end"] = micros
+                    break
+
+    done = defaultdict(list)
+    for key, items in requests.items():
+        group = []
+        for request in items + [None]:
+            if group and (request is None or request["start"] - group[0]["start"] > HEDGE_WINDOW):
+                answered = [r for r in group if r["end"] is not None]
+                first = min(answered, key=lambda r: r["end"]) if answered else None
+                done[key].append({"server": first["end"] - first["start"] if first else None})
+                group = []
+            if request is not None:
+                group.append(request)
+    return done
+
+
+def join(readers, gateway, server):
+    keys = set(gateway)
+    for reader in readers:
+        keys |= set(reader)
+
+    rows = []
+    for key in sorted(keys):
+        reader = next((r[key] for r in readers if key in r), [])
+        for i in range(max(len(reader), len(gateway.get(key, [])))):
+            r = reader[i] if i < len(reader) else None
+            g = gateway[key][i] if i < len(gateway.get(key, [])) else None
+            s = server[key][i] if i < len(server.get(key, [])) else None
+            row = {"device": key[0], "trace": key[1],
+                   "state": (r or g)["state"], "retries": r["retries"] if r else 0,
+                   "reader": r["total"] if r else None,
+                   "gateway": g["total"] if g else None,
+                   "upstream": g["upstream"] if g else None,
+                   "server": s["server"] if s else None}
+            row["bus"] = diff(row["reader"], row["gateway"])
+            row["network"] = diff(row["upstream"], row["server"])
+            row["local"] = diff(row["gateway"], row["upstream"])
+            rows.append(row)
+    return rows
+
+
+def diff(a, b):
+    return a - b if a is not None and b is not None else None
+
+
+def percentile(values, part):
+    # nearest rank
+    return values[max(0, math.ceil(len(values) * part) - 1)]
+
+
+COLUMNS = ["reader", "bus", "gateway", "local", "upstream", "network", "server"]
+
+
+def report(rows, top):
+    print(f"{len(rows)} transactions, ms")
+    print(f"{'':10}{'count':>8}{'p50':>9}{'p90':>9}{'p99':>9}{'max':>9}")
+    for column in COLUMNS:
+        values = sorted(row[column] for row in rows if row[column] is not None)
+        if not values:
+            continue
+        print(f"{column:10}{len(values):8}" +
+              "".join(f"{v / 1000:9.1f}" for v in (percentile(values, 0.5), percentile(values, 0.9),
+                                                     percentile(values, 0.99), values[-1])))
+
+    if top:
+        print(f"\nslowest {top}")
+        print(f"{'device':>6}{'trace':>7}{'state':>6}{'retry':>6}" + "".join(f"{c:>9}" for c in COLUMNS))
+        total = lambda row: row["reader"] if row["reader"] is not None else row["gateway"] or 0
+        for row in sorted(rows, key=total, reverse=True)[:top]:
+            print(f"{row['device']:6}{row['trace']:7}{row['state']:6}{row['retries']:6}" +
+                  "".join(f"{row[c] / 1000:9.1f}" if row[c] is not None else f"{'-':>9}" for c in COLUMNS))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="card transaction latency breakdown from TRACE_IDS logs")
+    parser.add_argument("--reader", action="append", default=[], help="serial log of reader (repeatable)")
+    parser.add_argument("--gateway", help="serial log of gateway")
+    parser.add_argument("--server", help="output of mock_server.py")
+    parser.add_argument("--top", type=int, default=10, help="slowest transactions to print")
+    args = parser.parse_args()
+
+    if not args.reader and not args.gateway:
+        parser.error("--reader or --gateway is required")
+
+    readers = [reader_log(path) for path in args.reader]
+    gateway = gateway_log(args.gateway) if args.gateway else {}
+    server = server_log(args.server) if args.server else {}
+    rows = join(readers, gateway, server)
+    if not rows:
+        print("no complete transactions", file=sys.stderr)
+        return
+    report(rows, args.top)
+
+
+if __name__ == "__main__":
+    main()
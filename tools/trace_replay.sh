@@ -0,0 +1,44 @@
+#!/bin/sh
+# Replays bus trace (recorded with TRACE_RECORD) to firmware built with TRACE_REPLAY.
+# Firmware keeps original timing itself (divided by trace_speed) and asks for every next record with "~>" line,
+# so trace is sent record by record. Everything firmware prints (debug, "~t" records of transmitted bytes) is saved to output.
+#
+# usage: trace_replay.sh <trace file> <serial port> [output file] [baud]
+#   trace_replay.sh site.log /dev/ttyUSB0 replay.log
+
+trace="$1"
+port="$2"
+output="${3:-replay.log}"
+baud="${4:-115200}"
+
+if [ -z "$trace" ] || [ -z "$port" ]; then
+    echo "usage: $0 <trace file> <serial port> [output file] [baud]" >&2
+    exit 1
+fi
+
+stty -F "$port" "$baud" raw -echo -hupcl || exit 1
+exec 3<>"$port"
+
+# wait until firmware asks for next record, saving all it prints
+wait_request()
+{
+    while IFS= read -r answer <&3; do
+        answer=$(printf '%s' "$answer" | tr -d '\r')
+        printf '%s\n' "$answer" >> "$output"
+        [ "$answer" = "~>" ] && return 0
+    done
+    return 1
+}
+
+: > "$output"
+records=0
+grep '^~[rtw]' "$trace" | tr -d '\r' | while IFS= read -r record; do
+    wait_request || break
+    printf '%s\n' "$record" >&3
+    records=$((records + 1))
+    printf '\rrecords sent: %d' "$records" >&2
+done
+echo >&2
+
+# firmware output after last record
+timeout 2 cat <&3 | tr -d '\r' >> "$output"